@@ -2,26 +2,41 @@
 #define VULKANTUT2_QUAD_H
 
 #include <vulkan/vulkan.h>
-#include <glm/vec2.hpp>
-#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <array>
 
 #include "transform.h"
+#include "DeviceAllocator.h"
+#include "UploadContext.h"
+#include "VertexLayout.h"
 
 namespace VulkanTut
 {
     class Quad
     {
+        ///16 bytes instead of 32 with float3 position, float3 color and float2 uv
         struct Vertex
         {
-            glm::vec3 pos;
-            glm::vec3 color;
-            glm::vec2 texCoord;
+            VertexFormats::Half4 pos;
+            VertexFormats::Unorm8x4 color;
+            VertexFormats::Unorm16x2 texCoord;
         };
 
+        using VertexDescription = VertexLayout<&Vertex::pos, &Vertex::color, &Vertex::texCoord>;
+        static_assert(VertexDescription::Stride == 16, "quad vertex is expected to stay packed");
+
         public:
+            ///per instance vertex data (binding 1), padded to 16 bytes
+            struct Instance
+            {
+                glm::mat4 model;
+                uint32_t texIndex;
+                uint32_t pad[3];
+            };
+
             Quad() = default;
-            void Create(VkDevice, VkPhysicalDevice, VkQueue, VkCommandPool transferCmdPool);
+            ///records vbo/ibo uploads into the context, buffers are usable once its batch completes
+            void Create(DeviceAllocator&, UploadContext&);
             void Delete() const;
 
             auto vbo() const { return _vbo; }
@@ -51,7 +66,7 @@ namespace VulkanTut
             {
                 VkDescriptorSetLayoutBinding uboLayout{};
                 uboLayout.binding = 0;
-                uboLayout.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                uboLayout.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
                 uboLayout.descriptorCount = 1;
                 uboLayout.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
                 uboLayout.pImmutableSamplers = nullptr;
@@ -59,55 +74,50 @@ namespace VulkanTut
                 return uboLayout;
             }
 
-            static auto GetVertexBindingDescription()
+            static constexpr auto GetVertexBindingDescription() { return VertexDescription::Binding(0); }
+
+            ///locations 0 - 2, the fetch widens to the shader's float inputs (w is dropped by the vec3 position input)
+            static constexpr auto GetVertexAttribDescriptions() { return VertexDescription::Attributes(0); }
+
+            static auto GetInstanceBindingDescription()
             {
                 VkVertexInputBindingDescription bindingDesc{};
-                bindingDesc.binding = 0;
-                bindingDesc.stride = sizeof(Vertex);
-                bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+                bindingDesc.binding = 1;
+                bindingDesc.stride = sizeof(Instance);
+                bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
                 return bindingDesc;
             }
 
-            static auto GetVertexAttribDescriptions()
+            ///mat4 takes 4 consecutive locations, one per column
+            static auto GetInstanceAttribDescriptions()
             {
-                std::array<VkVertexInputAttributeDescription, 3> attribDescs{};
-
-                attribDescs[0].binding = 0;
-                attribDescs[0].location = 0;
-                attribDescs[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-                attribDescs[0].offset = offsetof(Vertex, pos);
+                std::array<VkVertexInputAttributeDescription, 5> attribDescs{};
 
-                attribDescs[1].binding = 0;
-                attribDescs[1].location = 1;
-                attribDescs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-                attribDescs[1].offset = offsetof(Vertex, color);
+                for(uint32_t i{0}; i<4; ++i)
+                {
+                    attribDescs[i].binding = 1;
+                    attribDescs[i].location = 3 + i;
+                    attribDescs[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                    attribDescs[i].offset = offsetof(Instance, model) + i * sizeof(glm::vec4);
+                }
 
-                attribDescs[2].binding = 0;
-                attribDescs[2].location = 2;
-                attribDescs[2].format = VK_FORMAT_R32G32_SFLOAT;
-                attribDescs[2].offset = offsetof(Vertex, texCoord);
+                attribDescs[4].binding = 1;
+                attribDescs[4].location = 7;
+                attribDescs[4].format = VK_FORMAT_R32_UINT;
+                attribDescs[4].offset = offsetof(Instance, texIndex);
 
                 return attribDescs;
             }
 
         private:
-            void CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize);
-            std::tuple<VkBuffer, VkDeviceMemory> CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags);
-            VkDeviceMemory AllocateVertexBuffer(VkBuffer, VkMemoryPropertyFlags);
-            uint32_t FindMemType(uint32_t typeFilter, VkMemoryPropertyFlags);
-
-        private:
-            VkQueue _queue{VK_NULL_HANDLE};
-            VkCommandPool _cmdPool{VK_NULL_HANDLE};
-            VkPhysicalDevice _pDevice{VK_NULL_HANDLE};
-            VkDevice _device{VK_NULL_HANDLE};
+            DeviceAllocator* _allocator{nullptr};
 
             VkBuffer _vbo{VK_NULL_HANDLE};
-            VkDeviceMemory _vboMemory{VK_NULL_HANDLE};
+            Allocation _vboMemory{};
 
             VkBuffer _ibo{VK_NULL_HANDLE};
-            VkDeviceMemory _iboMemory{VK_NULL_HANDLE};
+            Allocation _iboMemory{};
     };
 
 }
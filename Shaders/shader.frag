@@ -2,12 +2,26 @@
 
 layout(location = 0) out vec4 fragment;
 
-layout(location = 0) in vec3 vColor;
+layout(location = 0) in vec4 vColor;
 layout(location = 1) in vec2 vTexCoord;
+layout(location = 2) flat in uint vTexIndex; ///unused while a single texture is bound
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+///MaterialFeature bits (PipelineState.h), fixed per pipeline variant
+layout(constant_id = 0) const uint FEATURES = 3u;
+const uint TEXTURED = 1u;
+const uint VERTEX_COLOR = 2u;
+///PipelineState::opacity, below 1 only for blended variants
+layout(constant_id = 1) const float OPACITY = 1.0;
+
 void main()
 {
-    fragment = vec4(vColor * texture(texSampler, vTexCoord).rgb, 1.0);
+    vec4 color = vec4(1.0);
+    if((FEATURES & VERTEX_COLOR) != 0u)
+        color *= vColor;
+    if((FEATURES & TEXTURED) != 0u)
+        color *= texture(texSampler, vTexCoord);
+
+    fragment = vec4(color.rgb, color.a * OPACITY);
 }
@@ -1,22 +1,35 @@
 #version 450
 
+///quantized in Quad::Vertex (half4, rgba8 unorm, unorm16x2), widened to float by the vertex fetch
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+layout(location = 1) in vec4 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
-layout(binding = 0) uniform mvpUBO
+layout(location = 3) in mat4 inInstanceModel;
+layout(location = 7) in uint inTexIndex;
+
+///per frame
+layout(binding = 0) uniform cameraUBO
 {
-    mat4 model;
     mat4 view;
     mat4 proj;
 };
 
-layout(location = 0) out vec3 vColor;
+///per draw, drawConstants in transform.h
+layout(push_constant) uniform drawConstants
+{
+    mat4 model;
+    uint texIndexBase;
+};
+
+layout(location = 0) out vec4 vColor;
 layout(location = 1) out vec2 vTexCoord;
+layout(location = 2) flat out uint vTexIndex;
 
 void main()
 {
     vColor = inColor;
     vTexCoord = inTexCoord;
-    gl_Position = proj * view * model * vec4(inPosition, 1.0);
+    vTexIndex = texIndexBase + inTexIndex;
+    gl_Position = proj * view * model * inInstanceModel * vec4(inPosition, 1.0);
 }
@@ -0,0 +1,30 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) out vec4 fragment;
+
+layout(location = 0) in vec4 vColor;
+layout(location = 1) in vec2 vTexCoord;
+layout(location = 2) flat in uint vTexIndex;
+
+///partially bound, only the first getTextureCount() elements are ever written
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+///MaterialFeature bits (PipelineState.h), fixed per pipeline variant
+layout(constant_id = 0) const uint FEATURES = 3u;
+const uint TEXTURED = 1u;
+const uint VERTEX_COLOR = 2u;
+///PipelineState::opacity, below 1 only for blended variants
+layout(constant_id = 1) const float OPACITY = 1.0;
+
+void main()
+{
+    vec4 color = vec4(1.0);
+    if((FEATURES & VERTEX_COLOR) != 0u)
+        color *= vColor;
+    ///instances of one draw sample different textures, the index isn't dynamically uniform
+    if((FEATURES & TEXTURED) != 0u)
+        color *= texture(textures[nonuniformEXT(vTexIndex)], vTexCoord);
+
+    fragment = vec4(color.rgb, color.a * OPACITY);
+}
@@ -0,0 +1,112 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace VulkanTut;
+
+void AssetLoader::Create(uint32_t threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    _stopping = false;
+    _workers.reserve(threadCount);
+    for(uint32_t i{0}; i<threadCount; ++i)
+        _workers.emplace_back(&AssetLoader::WorkerLoop, this);
+}
+
+void AssetLoader::Delete()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+        _jobs.clear();
+    }
+    _jobAvailable.notify_all();
+
+    for(auto& worker : _workers)
+        worker.join();
+
+    _workers.clear();
+    _completed.clear();
+}
+
+void AssetLoader::LoadImage(std::string path, std::function<void(Img&&)> onLoaded)
+{
+    Enqueue([path = std::move(path), onLoaded = std::move(onLoaded)]() -> Completion
+    {
+        ///images are move only, the completion has to be copyable for std::function
+        return [img = std::make_shared<Img>(path), onLoaded]() { onLoaded(std::move(*img)); };
+    });
+}
+
+void AssetLoader::LoadCompressedImage(std::string path, std::function<void(CompressedImg&&)> onLoaded)
+{
+    Enqueue([path = std::move(path), onLoaded = std::move(onLoaded)]() -> Completion
+    {
+        return [img = std::make_shared<CompressedImg>(path), onLoaded]() { onLoaded(std::move(*img)); };
+    });
+}
+
+uint32_t AssetLoader::Poll()
+{
+    std::vector<Completion> completed;
+    {
+        std::lock_guard lock(_mutex);
+        completed.swap(_completed);
+    }
+
+    ///outside the lock, a completion may queue follow up loads
+    for(auto& completion : completed)
+        completion();
+
+    return static_cast<uint32_t>(completed.size());
+}
+
+void AssetLoader::WaitIdle()
+{
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [this]{ return _jobs.empty() && _decoding == 0; });
+}
+
+uint32_t AssetLoader::pending() const
+{
+    std::lock_guard lock(_mutex);
+    return static_cast<uint32_t>(_jobs.size() + _completed.size()) + _decoding;
+}
+
+void AssetLoader::Enqueue(Job&& job)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _jobAvailable.notify_one();
+}
+
+void AssetLoader::WorkerLoop()
+{
+    std::unique_lock lock(_mutex);
+
+    while(true)
+    {
+        _jobAvailable.wait(lock, [this]{ return _stopping || !_jobs.empty(); });
+        if(_stopping)
+            return;
+
+        auto job = std::move(_jobs.front());
+        _jobs.pop_front();
+        ++_decoding;
+
+        lock.unlock();
+        auto completion = job();
+        lock.lock();
+
+        _completed.push_back(std::move(completion));
+        --_decoding;
+
+        if(_jobs.empty() && _decoding == 0)
+            _idle.notify_all();
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef VULKANTUT2_ASSETLOADER_H
+#define VULKANTUT2_ASSETLOADER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Img.h"
+#include "CompressedImg.h"
+
+namespace VulkanTut
+{
+    ///decodes images on a pool of worker threads. Completions never run on a worker, they are
+    ///queued and executed by Poll() on the thread that owns the device, so they can record uploads directly
+    class AssetLoader
+    {
+        using Completion = std::function<void()>;
+        using Job = std::function<Completion()>;
+
+        public:
+            AssetLoader() = default;
+
+            ///threadCount 0 picks hardware_concurrency - 1 (at least 1)
+            void Create(uint32_t threadCount = 0);
+            ///joins the workers, queued jobs and unpolled completions are dropped
+            void Delete();
+
+            void LoadImage(std::string path, std::function<void(Img&&)> onLoaded);
+            void LoadCompressedImage(std::string path, std::function<void(CompressedImg&&)> onLoaded);
+
+            ///runs the completions of every finished decode, returns how many ran
+            uint32_t Poll();
+            ///blocks until nothing is queued or decoding, completions still wait for Poll
+            void WaitIdle();
+
+            uint32_t pending() const;
+            auto threadCount() const { return static_cast<uint32_t>(_workers.size()); }
+
+        private:
+            void Enqueue(Job&&);
+            void WorkerLoop();
+
+        private:
+            std::vector<std::thread> _workers;
+            std::deque<Job> _jobs;
+            std::vector<Completion> _completed;
+            uint32_t _decoding{0};
+            bool _stopping{false};
+
+            mutable std::mutex _mutex;
+            std::condition_variable _jobAvailable;
+            std::condition_variable _idle;
+    };
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "VlkApp.h"
+#include "errLog.h"
+
+#include <algorithm>
+
+using namespace VulkanTut;
+
+bool VlkApp::CheckBindlessSupport()
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+
+    ///features2/properties2 are core 1.1 entry points
+    if(properties.apiVersion < VK_API_VERSION_1_1 ||
+       !CheckDeviceExtensionsSupport(_physicalDevice, {VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME}))
+        return false;
+
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &indexingFeatures;
+    vkGetPhysicalDeviceFeatures2(_physicalDevice, &features);
+
+    if(!indexingFeatures.shaderSampledImageArrayNonUniformIndexing || !indexingFeatures.runtimeDescriptorArray ||
+       !indexingFeatures.descriptorBindingPartiallyBound || !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+       !indexingFeatures.descriptorBindingUpdateUnusedWhilePending)
+        return false;
+
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(_physicalDevice, &properties2);
+
+    _bindlessCapacity = std::min({BINDLESS_TEXTURE_CAPACITY,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                  indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+
+    return _bindlessCapacity > 0;
+}
+
+void VlkApp::CreateBindlessLayout()
+{
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = _bindlessCapacity;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    ///elements past the texture count are never written, new slots may be written while older frames are pending
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT|
+                                                 VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT|
+                                                 VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    _bindlessSetLayout = _descriptorCache.Layout({&binding, 1}, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, {&bindingFlags, 1});
+
+    ///update-after-bind sets need pools created for them, sized for one set per frame in flight
+    const std::array<DescriptorRatio, 1> ratios{{{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<float>(_bindlessCapacity)}}};
+    _bindlessDescriptors.Create(_device, ratios, MAX_FRAMES_IN_FLIGHT, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+}
+
+void VlkApp::CreateBindlessSets()
+{
+    for(auto& set : _bindlessSets)
+    {
+        set = _bindlessDescriptors.Allocate(_bindlessSetLayout);
+        if(set == VK_NULL_HANDLE)
+        {
+            LOG("allocation of bindless descriptor sets failed");
+            return;
+        }
+    }
+
+    for(uint32_t frame{0}; frame<MAX_FRAMES_IN_FLIGHT; ++frame)
+        for(uint32_t slot{0}; slot<_textures.size(); ++slot)
+            WriteTextureDescriptors(frame, slot);
+}
+
+void VlkApp::DeleteBindless()
+{
+    if(!_bindless)
+        return;
+
+    _bindlessDescriptors.Delete();
+}
@@ -10,7 +10,7 @@ void VlkApp::CreateCommandPool()
     VkCommandPoolCreateInfo cmdPoolCreateInfo{};
     cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     cmdPoolCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-    cmdPoolCreateInfo.flags = 0;
+    cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if(vkCreateCommandPool(_device, &cmdPoolCreateInfo, nullptr, &_cmdPool) != VK_SUCCESS)
     {
@@ -18,9 +18,23 @@ void VlkApp::CreateCommandPool()
     }
 }
 
+void VlkApp::CreateUploadContext()
+{
+    auto queueFamilyIndices = FindQueueFamilies(_physicalDevice);
+
+    _uploads.Create(_device, _allocator, _transferQueue, queueFamilyIndices.transferFamily.value(),
+                    _graphicsQueue, queueFamilyIndices.graphicsFamily.value());
+}
+
+void VlkApp::FlushUploads()
+{
+    _uploads.Wait(_uploads.Submit());
+    _uploads.Collect();
+}
+
 void VlkApp::CreateCommandBuffers()
 {
-    _cmdBuffers.resize(_swapChainFbos.size());
+    _cmdBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     VkCommandBufferAllocateInfo allocCreateInfo{};
     allocCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -32,92 +46,94 @@ void VlkApp::CreateCommandBuffers()
     {
         LOG("allocation of cmd buffers failed");
     }
-
-    for(size_t i{0}; i<_cmdBuffers.size(); ++i)
-    {
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = 0;
-        beginInfo.pInheritanceInfo = nullptr;
-
-        if(vkBeginCommandBuffer(_cmdBuffers[i], &beginInfo) != VK_SUCCESS)
-        {
-            LOG_ARGS("failed to begin recording {} cmd buffer", i);
-        }
-
-        VkRenderPassBeginInfo renderPassBeginInfo{};
-        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassBeginInfo.renderPass = _renderPass;
-        renderPassBeginInfo.framebuffer = _swapChainFbos[i];
-        renderPassBeginInfo.renderArea.offset = {0, 0};
-        renderPassBeginInfo.renderArea.extent = _swapChainExtent;
-
-        std::array<VkClearValue, 2> clearColorValues{};
-        clearColorValues[0].color = {{.0f, .0f, .0f, 1.f}};
-        clearColorValues[1].depthStencil = {1.f, 0};
-        renderPassBeginInfo.pClearValues = clearColorValues.data();
-        renderPassBeginInfo.clearValueCount = clearColorValues.size();
-
-        vkCmdBeginRenderPass(_cmdBuffers[i], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(_cmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
-
-        VkDeviceSize offset{0};
-        VkBuffer vboBuffer{_quad.vbo()};
-        VkBuffer iboBuffer{_quad.ibo()};
-
-        vkCmdBindVertexBuffers(_cmdBuffers[i], 0, 1, &vboBuffer, &offset);
-        vkCmdBindIndexBuffer(_cmdBuffers[i], iboBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-        vkCmdBindDescriptorSets(_cmdBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_descSets[i], 0, nullptr);
-
-        vkCmdDrawIndexed(_cmdBuffers[i], Quad::indices.size(), 1, 0, 0, 0);
-
-        vkCmdEndRenderPass(_cmdBuffers[i]);
-
-        if(vkEndCommandBuffer(_cmdBuffers[i]) != VK_SUCCESS)
-        {
-            LOG_ARGS("recording of {} command buffer failed", i);
-        }
-    }
 }
 
-VkCommandBuffer VlkApp::BeginCmd()
+void VlkApp::RecordCommandBuffer(uint32_t frame, uint32_t imgID, std::optional<uint32_t> uboOffset)
 {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = _cmdPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer cmdBuff;
-    vkAllocateCommandBuffers(_device, &allocInfo, &cmdBuff);
+    auto cmdBuff = _cmdBuffers[frame];
+    vkResetCommandBuffer(cmdBuff, 0);
 
-    VkCommandBufferBeginInfo cmdBuffBeginInfo{};
-    cmdBuffBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdBuffBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = nullptr;
 
-    vkBeginCommandBuffer(cmdBuff, &cmdBuffBeginInfo);
-
-    return cmdBuff;
-}
-
-void VlkApp::EndCmd(VkCommandBuffer cmdBuff)
-{
-    vkEndCommandBuffer(cmdBuff);
+    if(vkBeginCommandBuffer(cmdBuff, &beginInfo) != VK_SUCCESS)
+    {
+        LOG_ARGS("failed to begin recording cmd buffer for image {}", imgID);
+    }
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &cmdBuff;
+    if(_timestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(cmdBuff, _timestampPool, frame * 2, 2);
+        vkCmdWriteTimestamp(cmdBuff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _timestampPool, frame * 2);
+    }
 
-    vkQueueSubmit(_transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(_transferQueue);
+    const bool gpuDriven = _gpuDriven && _cullFrames[frame].visible != VK_NULL_HANDLE && RecordCulling(cmdBuff, frame);
+
+    VkRenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = _renderPass;
+    renderPassBeginInfo.framebuffer = _swapChainFbos[imgID];
+    renderPassBeginInfo.renderArea.offset = {0, 0};
+    renderPassBeginInfo.renderArea.extent = _swapChainExtent;
+
+    std::array<VkClearValue, 2> clearColorValues{};
+    clearColorValues[0].color = {{.0f, .0f, .0f, 1.f}};
+    clearColorValues[1].depthStencil = {1.f, 0};
+    renderPassBeginInfo.pClearValues = clearColorValues.data();
+    renderPassBeginInfo.clearValueCount = clearColorValues.size();
+
+    vkCmdBeginRenderPass(cmdBuff, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+
+    VkViewport viewport{};
+    viewport.x = .0f;
+    viewport.y = .0f;
+    viewport.width = static_cast<float>(_swapChainExtent.width);
+    viewport.height = static_cast<float>(_swapChainExtent.height);
+    viewport.minDepth = .0f;
+    viewport.maxDepth = 1.f;
+    vkCmdSetViewport(cmdBuff, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = _swapChainExtent;
+    vkCmdSetScissor(cmdBuff, 0, 1, &scissor);
+
+    ///the image is still cleared and presented when the frame's uniforms were rejected
+    if(_instanceCount && uboOffset.has_value())
+    {
+        ///gpu driven draws the compacted survivors of the culling pass
+        std::array<VkDeviceSize, 2> offsets{0, 0};
+        std::array<VkBuffer, 2> vertexBuffers{_quad.vbo(), gpuDriven ? _cullFrames[frame].visible : _instanceBuffer};
+        VkBuffer iboBuffer{_quad.ibo()};
 
-    vkFreeCommandBuffers(_device, _cmdPool, 1, &cmdBuff);
-}
+        vkCmdBindVertexBuffers(cmdBuff, 0, vertexBuffers.size(), vertexBuffers.data(), offsets.data());
+        vkCmdBindIndexBuffer(cmdBuff, iboBuffer, 0, VK_INDEX_TYPE_UINT16);
 
+        vkCmdBindDescriptorSets(cmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_descSets[frame], 1, &uboOffset.value());
+        if(_bindless)
+            vkCmdBindDescriptorSets(cmdBuff, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 1, 1, &_bindlessSets[frame], 0, nullptr);
 
+        vkCmdPushConstants(cmdBuff, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(_drawConstants), &_drawConstants);
 
+        if(gpuDriven)
+            vkCmdDrawIndexedIndirect(cmdBuff, _cullFrames[frame].indirect, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+        else
+            vkCmdDrawIndexed(cmdBuff, Quad::indices.size(), _instanceCount, 0, 0, 0);
+    }
 
+    vkCmdEndRenderPass(cmdBuff);
 
+    if(_timestampPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(cmdBuff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _timestampPool, frame * 2 + 1);
+        _timestampsPending[frame] = true;
+    }
 
+    if(vkEndCommandBuffer(cmdBuff) != VK_SUCCESS)
+    {
+        LOG_ARGS("recording of cmd buffer for image {} failed", imgID);
+    }
+}
@@ -0,0 +1,244 @@
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+
+#include "VlkApp.h"
+#include "errLog.h"
+
+using namespace VulkanTut;
+
+namespace
+{
+    struct CullPushConstants
+    {
+        std::array<glm::vec4, 6> planes;
+        uint32_t count;
+    };
+
+    ///the compute pass's set, written in one call through _cullTemplate
+    struct CullDescriptors
+    {
+        VkDescriptorBufferInfo instances;
+        VkDescriptorBufferInfo visible;
+        VkDescriptorBufferInfo indirect;
+    };
+
+    constexpr std::array<DescriptorField, 3> CullDescriptorFields
+    {{
+        {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, offsetof(CullDescriptors, instances)},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, offsetof(CullDescriptors, visible)},
+        {2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, offsetof(CullDescriptors, indirect)}
+    }};
+
+    constexpr uint32_t CullGroupSize{64};
+}
+
+void VlkApp::CreateCulling(std::string_view cSh)
+{
+    if(!_gpuDriven)
+        return;
+
+    _cullProgram = _shaderLibrary.LoadProgram({{VK_SHADER_STAGE_COMPUTE_BIT, cSh}});
+    ///a compute pipeline without its module is invalid, instances are drawn directly instead
+    if(!_cullProgram.valid())
+    {
+        LOG_ARGS("culling program {} is incomplete, gpu driven culling disabled", cSh);
+        _gpuDriven = false;
+        return;
+    }
+
+    _cullSetLayout = _descriptorCache.Layout(LayoutBindings(CullDescriptorFields),
+                                             _pushDescriptors ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR : 0);
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &_cullSetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, nullptr, &_cullPipelineLayout) != VK_SUCCESS)
+    {
+        LOG("culling pipeline layout creation failed");
+    }
+
+    if(_pushDescriptors)
+        _cullTemplate.CreatePush(_device, CullDescriptorFields, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipelineLayout, 0);
+    else
+        _cullTemplate.Create(_device, _cullSetLayout, CullDescriptorFields);
+
+    auto beginTime = std::chrono::steady_clock::now();
+
+    _cullPipeline = BuildCullPipeline(_cullProgram);
+
+    _pipelineCache.Record(nullptr, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count());
+}
+
+VkPipeline VlkApp::BuildCullPipeline(const ShaderProgram& program) const
+{
+    VkComputePipelineCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    createInfo.stage.module = program.module(VK_SHADER_STAGE_COMPUTE_BIT);
+    createInfo.stage.pName = "main";
+    createInfo.layout = _cullPipelineLayout;
+    createInfo.basePipelineHandle = VK_NULL_HANDLE;
+    createInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline{VK_NULL_HANDLE};
+    if(vkCreateComputePipelines(_device, _pipelineCache.handle(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        LOG("culling pipeline creation failed");
+    }
+
+    return pipeline;
+}
+
+void VlkApp::CreateCullingBuffers()
+{
+    for(auto& cull : _cullFrames)
+    {
+        if(cull.visible != VK_NULL_HANDLE)
+        {
+            _deletionQueue.Push(_frameNumber, [this, cull]()
+            {
+                _allocator.DestroyBuffer(cull.visible, cull.visibleMemory);
+                _allocator.DestroyBuffer(cull.indirect, cull.indirectMemory);
+            });
+        }
+
+        cull = {};
+    }
+
+    if(!_instanceCount)
+        return;
+
+    const VkDeviceSize visibleSize = sizeof(Quad::Instance) * _instanceCount;
+
+    for(size_t i{0}; i<MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        auto& cull = _cullFrames[i];
+
+        std::tie(cull.visible, cull.visibleMemory) = _allocator.CreateBuffer(
+                visibleSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+
+        std::tie(cull.indirect, cull.indirectMemory) = _allocator.CreateBuffer(
+                sizeof(VkDrawIndexedIndirectCommand),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT|VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT|VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+    }
+}
+
+bool VlkApp::RecordCulling(VkCommandBuffer cmdBuff, uint32_t frame)
+{
+    const auto& cull = _cullFrames[frame];
+
+    ///allocated before anything is recorded, the frame's pool is reset when the slot comes around
+    VkDescriptorSet set{VK_NULL_HANDLE};
+    if(!_cullTemplate.isPush())
+    {
+        set = _frameDescriptors[frame].Allocate(_cullSetLayout);
+        if(set == VK_NULL_HANDLE)
+        {
+            LOG_ARGS("no cull descriptor set for frame {}, culling skipped", frame);
+            return false;
+        }
+    }
+
+    ///transient, the instance buffer may be replaced any frame
+    CullDescriptors descriptors
+    {
+        {_instanceBuffer, 0, VK_WHOLE_SIZE},
+        {cull.visible, 0, VK_WHOLE_SIZE},
+        {cull.indirect, 0, VK_WHOLE_SIZE}
+    };
+
+    ///instanceCount is the atomic counter the compute pass appends to
+    VkDrawIndexedIndirectCommand drawCmd{};
+    drawCmd.indexCount = Quad::indices.size();
+    vkCmdUpdateBuffer(cmdBuff, cull.indirect, 0, sizeof(drawCmd), &drawCmd);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT|VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    CullPushConstants pushConstants{};
+    pushConstants.planes = _frustumPlanes;
+    pushConstants.count = _instanceCount;
+
+    vkCmdBindPipeline(cmdBuff, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline);
+    if(_cullTemplate.isPush())
+    {
+        _cullTemplate.Push(cmdBuff, descriptors);
+    }
+    else
+    {
+        _cullTemplate.Update(set, descriptors);
+        vkCmdBindDescriptorSets(cmdBuff, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipelineLayout, 0, 1, &set, 0, nullptr);
+    }
+    vkCmdPushConstants(cmdBuff, _cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuff, (_instanceCount + CullGroupSize - 1) / CullGroupSize, 1, 1);
+
+    VkMemoryBarrier cullBarrier{};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT|VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+    vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT|VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+                         1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+    return true;
+}
+
+///Gribb-Hartmann extraction from the clip matrix, depth range [0, 1]
+std::array<glm::vec4, 6> VlkApp::ExtractFrustumPlanes(const glm::mat4& clip)
+{
+    auto row = [&clip](int i){ return glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]); };
+
+    std::array<glm::vec4, 6> planes
+    {
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) + row(1),
+        row(3) - row(1),
+        row(2),
+        row(3) - row(2)
+    };
+
+    for(auto& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    return planes;
+}
+
+void VlkApp::DeleteCulling()
+{
+    if(!_gpuDriven)
+        return;
+
+    for(auto& cull : _cullFrames)
+    {
+        _allocator.DestroyBuffer(cull.visible, cull.visibleMemory);
+        _allocator.DestroyBuffer(cull.indirect, cull.indirectMemory);
+    }
+
+    _cullTemplate.Delete();
+    vkDestroyPipeline(_device, _cullPipeline, nullptr);
+    vkDestroyPipelineLayout(_device, _cullPipelineLayout, nullptr);
+}
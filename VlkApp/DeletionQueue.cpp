@@ -0,0 +1,25 @@
+#include "DeletionQueue.h"
+
+using namespace VulkanTut;
+
+void DeletionQueue::Push(uint64_t safeAfterFrames, std::function<void()>&& deleter)
+{
+    _entries.push_back({safeAfterFrames, std::move(deleter)});
+}
+
+void DeletionQueue::Flush(uint64_t completedFrames)
+{
+    while(!_entries.empty() && _entries.front().safeAfterFrames <= completedFrames)
+    {
+        _entries.front().deleter();
+        _entries.pop_front();
+    }
+}
+
+void DeletionQueue::FlushAll()
+{
+    for(auto& entry : _entries)
+        entry.deleter();
+
+    _entries.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef VULKANTUT2_DELETIONQUEUE_H
+#define VULKANTUT2_DELETIONQUEUE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace VulkanTut
+{
+    ///defers destruction of objects that frames still in flight may reference,
+    ///entries are keyed by a frame count and run once that many frames are known to be complete
+    class DeletionQueue
+    {
+        public:
+            DeletionQueue() = default;
+
+            ///frames must be pushed in non decreasing order
+            void Push(uint64_t safeAfterFrames, std::function<void()>&& deleter);
+
+            ///runs every deleter whose frame count is <= completedFrames
+            void Flush(uint64_t completedFrames);
+
+            ///device must be idle
+            void FlushAll();
+
+            auto size() const { return _entries.size(); }
+
+        private:
+            struct Entry
+            {
+                uint64_t safeAfterFrames;
+                std::function<void()> deleter;
+            };
+
+            std::deque<Entry> _entries;
+    };
+}
+
+#endif
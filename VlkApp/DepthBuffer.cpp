@@ -33,9 +33,7 @@ void VlkApp::CreateDepthBuffer()
     std::tie(_depthImg, _depthImgMemory) = CreateImage(_swapChainExtent.width, _swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
                                  VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
+    ///no explicit transition, the render pass takes it from UNDEFINED
     _depthImgView = CreateImageView(_depthImg, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-
-    TransitionImageLayout(_depthImg, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-
 }
 
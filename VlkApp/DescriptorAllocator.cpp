@@ -0,0 +1,136 @@
+#include "DescriptorAllocator.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace VulkanTut;
+
+void DescriptorAllocator::Create(VkDevice device, std::span<const DescriptorRatio> ratios, uint32_t setsPerPool,
+                                 VkDescriptorPoolCreateFlags flags)
+{
+    _device = device;
+    _ratios.assign(ratios.begin(), ratios.end());
+    _setsPerPool = std::clamp(setsPerPool, 1u, MaxSetsPerPool);
+    _flags = flags;
+}
+
+void DescriptorAllocator::Delete()
+{
+    if(_current != VK_NULL_HANDLE)
+        _usedPools.push_back(_current);
+
+    for(auto pool : _usedPools)
+        vkDestroyDescriptorPool(_device, pool, nullptr);
+    for(auto pool : _freePools)
+        vkDestroyDescriptorPool(_device, pool, nullptr);
+
+    _current = VK_NULL_HANDLE;
+    _usedPools.clear();
+    _freePools.clear();
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, VkDescriptorPool* pool)
+{
+    if(_current == VK_NULL_HANDLE)
+        _current = NextPool();
+    if(_current == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = _current;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set{VK_NULL_HANDLE};
+    auto result = vkAllocateDescriptorSets(_device, &allocInfo, &set);
+
+    ///a full pool is kept until Reset, the allocation is retried once in a fresh one
+    if(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        _usedPools.push_back(_current);
+        _current = NextPool();
+        if(_current == VK_NULL_HANDLE)
+            return VK_NULL_HANDLE;
+
+        allocInfo.descriptorPool = _current;
+        result = vkAllocateDescriptorSets(_device, &allocInfo, &set);
+    }
+
+    if(result != VK_SUCCESS)
+    {
+        LOG_ARGS("descriptor set allocation failed ({})", static_cast<int32_t>(result));
+        return VK_NULL_HANDLE;
+    }
+
+    if(pool != nullptr)
+        *pool = _current;
+
+    return set;
+}
+
+void DescriptorAllocator::Free(VkDescriptorPool pool, VkDescriptorSet set)
+{
+    vkFreeDescriptorSets(_device, pool, 1, &set);
+
+    ///retried by NextPool, a pool that still has no room for the layout is put aside again
+    auto used = std::find(_usedPools.begin(), _usedPools.end(), pool);
+    if(used != _usedPools.end())
+    {
+        _usedPools.erase(used);
+        _freePools.push_back(pool);
+    }
+}
+
+void DescriptorAllocator::Reset()
+{
+    if(_current != VK_NULL_HANDLE)
+        _usedPools.push_back(_current);
+    _current = VK_NULL_HANDLE;
+
+    ///pools put back by Free may still hold sets
+    if(_flags & VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
+        for(auto pool : _freePools)
+            vkResetDescriptorPool(_device, pool, 0);
+
+    for(auto pool : _usedPools)
+    {
+        vkResetDescriptorPool(_device, pool, 0);
+        _freePools.push_back(pool);
+    }
+    _usedPools.clear();
+}
+
+VkDescriptorPool DescriptorAllocator::NextPool()
+{
+    if(!_freePools.empty())
+    {
+        auto pool = _freePools.back();
+        _freePools.pop_back();
+        return pool;
+    }
+
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    poolSizes.reserve(_ratios.size());
+    for(const auto&[type, perSet] : _ratios)
+        poolSizes.push_back({type, std::max(1u, static_cast<uint32_t>(std::ceil(perSet * static_cast<float>(_setsPerPool))))});
+
+    VkDescriptorPoolCreateInfo poolCreateInfo{};
+    poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCreateInfo.flags = _flags;
+    poolCreateInfo.maxSets = _setsPerPool;
+    poolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolCreateInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool pool{VK_NULL_HANDLE};
+    if(vkCreateDescriptorPool(_device, &poolCreateInfo, nullptr, &pool) != VK_SUCCESS)
+    {
+        LOG_ARGS("descriptor pool creation for {} sets failed", _setsPerPool);
+        return VK_NULL_HANDLE;
+    }
+
+    _setsPerPool = std::min(_setsPerPool * 2, MaxSetsPerPool);
+
+    return pool;
+}
@@ -0,0 +1,58 @@
+#ifndef VULKANTUT2_DESCRIPTORALLOCATOR_H
+#define VULKANTUT2_DESCRIPTORALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTut
+{
+    ///descriptors of a type reserved per set when a pool is sized
+    struct DescriptorRatio
+    {
+        VkDescriptorType type;
+        float perSet;
+    };
+
+    ///hands out descriptor sets from a chain of pools. When the current pool runs out
+    ///(VK_ERROR_OUT_OF_POOL_MEMORY / VK_ERROR_FRAGMENTED_POOL) it is put aside and a recycled or new one,
+    ///twice the size of the last up to MaxSetsPerPool, takes over. Reset() recycles every pool at once,
+    ///which is how sets that only live for one frame are released
+    class DescriptorAllocator
+    {
+        public:
+            DescriptorAllocator() = default;
+
+            void Create(VkDevice, std::span<const DescriptorRatio> ratios, uint32_t setsPerPool,
+                        VkDescriptorPoolCreateFlags flags = 0);
+            void Delete();
+
+            ///pool receives the pool the set came from, needed by Free
+            VkDescriptorSet Allocate(VkDescriptorSetLayout, VkDescriptorPool* pool = nullptr);
+            ///only with VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT. A full pool regains space
+            ///and goes back into rotation, so allocators that are never Reset do not leak pool capacity
+            void Free(VkDescriptorPool, VkDescriptorSet);
+            ///every set allocated so far is released, none may still be in use by the gpu
+            void Reset();
+
+            auto poolCount() const { return static_cast<uint32_t>(_usedPools.size() + _freePools.size()) + (_current != VK_NULL_HANDLE); }
+
+            static constexpr uint32_t MaxSetsPerPool{4096};
+
+        private:
+            VkDescriptorPool NextPool();
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            std::vector<DescriptorRatio> _ratios;
+            VkDescriptorPoolCreateFlags _flags{0};
+            uint32_t _setsPerPool{0}; ///of the next pool created
+
+            VkDescriptorPool _current{VK_NULL_HANDLE};
+            std::vector<VkDescriptorPool> _usedPools; ///full, reclaimed by Reset
+            std::vector<VkDescriptorPool> _freePools; ///reset or with freed sets, reused before a new pool is created
+    };
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "VlkApp.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+using namespace VulkanTut;
+
+namespace
+{
+    ///a per object set as it would look with one per draw: two buffer ranges and a texture
+    struct ObjectDescriptors
+    {
+        VkDescriptorBufferInfo object;
+        VkDescriptorBufferInfo material;
+        VkDescriptorImageInfo texture;
+    };
+
+    constexpr std::array<DescriptorField, 3> ObjectDescriptorFields
+    {{
+        {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT, offsetof(ObjectDescriptors, object)},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, offsetof(ObjectDescriptors, material)},
+        {2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, offsetof(ObjectDescriptors, texture)}
+    }};
+
+    constexpr std::array<DescriptorRatio, 2> ObjectDescriptorRatios{{{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2}, {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}}};
+
+    ///distinct ranges so no update is a repeat of the previous one
+    constexpr uint32_t BenchSlices{64};
+    constexpr uint32_t BenchRounds{5};
+
+    template<typename Fn>
+    double BestOf(Fn&& fn)
+    {
+        double best{std::numeric_limits<double>::max()};
+        for(uint32_t round{0}; round<BenchRounds; ++round)
+        {
+            auto beginTime = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count());
+        }
+
+        return best;
+    }
+
+    void AppendWrites(std::vector<VkWriteDescriptorSet>& writes, VkDescriptorSet set, const ObjectDescriptors& descriptors)
+    {
+        const std::array<const void*, 3> infos{&descriptors.object, &descriptors.material, &descriptors.texture};
+        for(size_t i{0}; i<ObjectDescriptorFields.size(); ++i)
+        {
+            const bool isImage = IsImageDescriptor(ObjectDescriptorFields[i].type);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = set;
+            write.dstBinding = ObjectDescriptorFields[i].binding;
+            write.dstArrayElement = 0;
+            write.descriptorType = ObjectDescriptorFields[i].type;
+            write.descriptorCount = 1;
+            write.pBufferInfo = isImage ? nullptr : static_cast<const VkDescriptorBufferInfo*>(infos[i]);
+            write.pImageInfo = isImage ? static_cast<const VkDescriptorImageInfo*>(infos[i]) : nullptr;
+            writes.push_back(write);
+        }
+    }
+}
+
+VlkApp::DescriptorUpdateTimings VlkApp::BenchmarkDescriptorUpdates(uint32_t sets)
+{
+    DescriptorUpdateTimings timings{};
+    if(!sets || _textures.empty())
+        return timings;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+    const auto alignment = std::max<VkDeviceSize>(properties.limits.minStorageBufferOffsetAlignment, 16);
+
+    auto[buffer, memory] = _allocator.CreateBuffer(alignment * BenchSlices, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::vector<ObjectDescriptors> descriptors(sets);
+    for(uint32_t i{0}; i<sets; ++i)
+    {
+        descriptors[i].object = {buffer, alignment * (i % BenchSlices), alignment};
+        descriptors[i].material = {buffer, alignment * ((i + 1) % BenchSlices), alignment};
+        descriptors[i].texture = {_texSampler, _textures[0].tex.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+
+    const auto bindings = LayoutBindings(ObjectDescriptorFields);
+    auto layout = _descriptorCache.Layout(bindings);
+
+    DescriptorAllocator allocator;
+    allocator.Create(_device, ObjectDescriptorRatios, DescriptorAllocator::MaxSetsPerPool);
+
+    std::vector<VkDescriptorSet> descSets(sets);
+    for(auto& set : descSets)
+        set = allocator.Allocate(layout);
+
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(static_cast<size_t>(sets) * ObjectDescriptorFields.size());
+
+    timings.writes = BestOf([&]
+    {
+        for(uint32_t i{0}; i<sets; ++i)
+        {
+            writes.clear();
+            AppendWrites(writes, descSets[i], descriptors[i]);
+            vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+    });
+
+    timings.batchedWrites = BestOf([&]
+    {
+        writes.clear();
+        for(uint32_t i{0}; i<sets; ++i)
+            AppendWrites(writes, descSets[i], descriptors[i]);
+        vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    });
+
+    DescriptorTemplate updateTemplate;
+    if(updateTemplate.Create(_device, layout, ObjectDescriptorFields))
+        timings.templated = BestOf([&]{ updateTemplate.Update<ObjectDescriptors>(descSets, descriptors); });
+    updateTemplate.Delete();
+
+    if(_pushDescriptors)
+    {
+        auto pushLayout = _descriptorCache.Layout(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.setLayoutCount = 1;
+        pipelineLayoutCreateInfo.pSetLayouts = &pushLayout;
+
+        VkPipelineLayout pipelineLayout{VK_NULL_HANDLE};
+        vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = _cmdPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cmdBuff{VK_NULL_HANDLE};
+        if(vkAllocateCommandBuffers(_device, &allocInfo, &cmdBuff) != VK_SUCCESS)
+        {
+            LOG("allocation of descriptor benchmark cmd buffer failed");
+        }
+
+        DescriptorTemplate pushTemplate;
+        if(cmdBuff != VK_NULL_HANDLE &&
+           pushTemplate.CreatePush(_device, ObjectDescriptorFields, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0))
+        {
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            ///recorded only, never submitted. Every push replaces the previous one like a per draw push would
+            timings.pushed = BestOf([&]
+            {
+                vkBeginCommandBuffer(cmdBuff, &beginInfo);
+                for(const auto& objectDescriptors : descriptors)
+                    pushTemplate.Push(cmdBuff, objectDescriptors);
+                vkEndCommandBuffer(cmdBuff);
+            });
+        }
+
+        pushTemplate.Delete();
+        if(cmdBuff != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(_device, _cmdPool, 1, &cmdBuff);
+        vkDestroyPipelineLayout(_device, pipelineLayout, nullptr);
+    }
+
+    ///nothing was submitted, the sets and the buffer were never in use
+    allocator.Delete();
+    _allocator.DestroyBuffer(buffer, memory);
+
+    return timings;
+}
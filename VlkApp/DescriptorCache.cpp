@@ -0,0 +1,215 @@
+#include "DescriptorCache.h"
+#include "Hash.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <type_traits>
+
+using namespace VulkanTut;
+
+namespace
+{
+    template<typename Handle>
+    uint64_t HandleBits(Handle handle)
+    {
+        ///dispatchable handles are pointers, non-dispatchable ones pointers or uint64_t depending on the platform
+        if constexpr(std::is_pointer_v<Handle>)
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        else
+            return static_cast<uint64_t>(handle);
+    }
+
+    uint64_t HashWord64(uint64_t value, uint64_t seed)
+    {
+        seed = Fnv1aWord(static_cast<uint32_t>(value), seed);
+        return Fnv1aWord(static_cast<uint32_t>(value >> 32), seed);
+    }
+
+    bool SameBinding(const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+    {
+        return a.binding == b.binding && a.descriptorType == b.descriptorType &&
+               a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+    }
+}
+
+bool VulkanTut::IsImageDescriptor(VkDescriptorType type)
+{
+    return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+           type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+}
+
+DescriptorWrite DescriptorWrite::Buffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    DescriptorWrite write{};
+    write.binding = binding;
+    write.type = type;
+    write.buffer = {buffer, offset, range};
+    return write;
+}
+
+DescriptorWrite DescriptorWrite::Image(uint32_t binding, VkDescriptorType type, VkImageView view, VkSampler sampler, VkImageLayout layout)
+{
+    DescriptorWrite write{};
+    write.binding = binding;
+    write.type = type;
+    write.image = {sampler, view, layout};
+    return write;
+}
+
+bool DescriptorWrite::operator==(const DescriptorWrite& other) const
+{
+    return binding == other.binding && type == other.type &&
+           buffer.buffer == other.buffer.buffer && buffer.offset == other.buffer.offset && buffer.range == other.buffer.range &&
+           image.sampler == other.image.sampler && image.imageView == other.image.imageView && image.imageLayout == other.image.imageLayout;
+}
+
+void VulkanTut::WriteDescriptors(VkDevice device, VkDescriptorSet set, std::span<const DescriptorWrite> writes)
+{
+    std::vector<VkWriteDescriptorSet> descWrites(writes.size());
+    for(size_t i{0}; i<writes.size(); ++i)
+    {
+        const auto& write = writes[i];
+        const bool isImage = IsImageDescriptor(write.type);
+
+        descWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descWrites[i].dstSet = set;
+        descWrites[i].dstBinding = write.binding;
+        descWrites[i].dstArrayElement = 0;
+        descWrites[i].descriptorType = write.type;
+        descWrites[i].descriptorCount = 1;
+        descWrites[i].pBufferInfo = isImage ? nullptr : &write.buffer;
+        descWrites[i].pImageInfo = isImage ? &write.image : nullptr;
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descWrites.size()), descWrites.data(), 0, nullptr);
+}
+
+void DescriptorCache::Create(VkDevice device, std::span<const DescriptorRatio> ratios)
+{
+    _device = device;
+    _stats = {};
+    _allocator.Create(_device, ratios, 64, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+}
+
+void DescriptorCache::Delete()
+{
+    _sets.clear();
+    _allocator.Delete();
+
+    for(const auto&[hash, entry] : _layouts)
+        vkDestroyDescriptorSetLayout(_device, entry.layout, nullptr);
+    _layouts.clear();
+}
+
+VkDescriptorSetLayout DescriptorCache::Layout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                              VkDescriptorSetLayoutCreateFlags flags,
+                                              std::span<const VkDescriptorBindingFlags> bindingFlags)
+{
+    uint64_t hash = Fnv1aWord(flags, Fnv1aBasis);
+    for(size_t i{0}; i<bindings.size(); ++i)
+    {
+        for(uint32_t word : {bindings[i].binding, static_cast<uint32_t>(bindings[i].descriptorType),
+                             bindings[i].descriptorCount, bindings[i].stageFlags})
+            hash = Fnv1aWord(word, hash);
+
+        if(!bindingFlags.empty())
+            hash = Fnv1aWord(bindingFlags[i], hash);
+    }
+
+    auto[first, last] = _layouts.equal_range(hash);
+    for(auto it = first; it != last; ++it)
+    {
+        const auto& entry = it->second;
+        if(entry.flags == flags &&
+           std::equal(bindings.begin(), bindings.end(), entry.bindings.begin(), entry.bindings.end(), SameBinding) &&
+           std::equal(bindingFlags.begin(), bindingFlags.end(), entry.bindingFlags.begin(), entry.bindingFlags.end()))
+        {
+            ++_stats.layoutHits;
+            return entry.layout;
+        }
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+    layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutCreateInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+    layoutCreateInfo.flags = flags;
+    layoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutCreateInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+    if(vkCreateDescriptorSetLayout(_device, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS)
+    {
+        LOG_ARGS("descriptor set layout creation failed, {} bindings", bindings.size());
+        return VK_NULL_HANDLE;
+    }
+
+    ++_stats.layouts;
+    _layouts.emplace(hash, LayoutEntry{{bindings.begin(), bindings.end()}, flags, {bindingFlags.begin(), bindingFlags.end()}, layout});
+
+    return layout;
+}
+
+VkDescriptorSet DescriptorCache::Set(VkDescriptorSetLayout layout, std::span<const DescriptorWrite> writes)
+{
+    uint64_t hash = HashWord64(HandleBits(layout), Fnv1aBasis);
+    for(const auto& write : writes)
+    {
+        hash = Fnv1aWord(write.binding, hash);
+        hash = Fnv1aWord(static_cast<uint32_t>(write.type), hash);
+        for(uint64_t value : {HandleBits(write.buffer.buffer), write.buffer.offset, write.buffer.range,
+                              HandleBits(write.image.sampler), HandleBits(write.image.imageView),
+                              static_cast<uint64_t>(write.image.imageLayout)})
+            hash = HashWord64(value, hash);
+    }
+
+    auto[first, last] = _sets.equal_range(hash);
+    for(auto it = first; it != last; ++it)
+    {
+        const auto& entry = it->second;
+        if(entry.layout == layout && std::equal(writes.begin(), writes.end(), entry.writes.begin(), entry.writes.end()))
+        {
+            ++_stats.setHits;
+            return entry.set;
+        }
+    }
+
+    VkDescriptorPool pool{VK_NULL_HANDLE};
+    auto set = _allocator.Allocate(layout, &pool);
+    if(set == VK_NULL_HANDLE)
+        return VK_NULL_HANDLE;
+
+    WriteDescriptors(_device, set, writes);
+
+    ++_stats.sets;
+    _sets.emplace(hash, SetEntry{layout, {writes.begin(), writes.end()}, set, pool});
+
+    return set;
+}
+
+void DescriptorCache::EvictImageView(VkImageView view)
+{
+    for(auto it = _sets.begin(); it != _sets.end(); )
+    {
+        const auto& writes = it->second.writes;
+        if(std::none_of(writes.begin(), writes.end(), [view](const auto& write){ return write.image.imageView == view; }))
+        {
+            ++it;
+            continue;
+        }
+
+        _allocator.Free(it->second.pool, it->second.set);
+        ++_stats.evicted;
+        it = _sets.erase(it);
+    }
+}
+
+void DescriptorCache::PrintStats() const
+{
+    fmt::print("| descriptor cache | {} layouts | {} layout hits | {} sets | {} set hits | {} evicted | {} pools |\n",
+               _stats.layouts, _stats.layoutHits, _stats.sets, _stats.setHits, _stats.evicted, _allocator.poolCount());
+}
@@ -0,0 +1,96 @@
+#ifndef VULKANTUT2_DESCRIPTORCACHE_H
+#define VULKANTUT2_DESCRIPTORCACHE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "DescriptorAllocator.h"
+
+namespace VulkanTut
+{
+    ///VkDescriptorImageInfo or VkDescriptorBufferInfo, texel buffers are not supported (they would need a VkBufferView)
+    bool IsImageDescriptor(VkDescriptorType);
+
+    ///array element 0 of one binding, plain data so the contents of a set can be hashed and compared
+    struct DescriptorWrite
+    {
+        uint32_t binding{0};
+        VkDescriptorType type{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER};
+        VkDescriptorBufferInfo buffer{};
+        VkDescriptorImageInfo image{};
+
+        static DescriptorWrite Buffer(uint32_t binding, VkDescriptorType, VkBuffer, VkDeviceSize offset, VkDeviceSize range);
+        static DescriptorWrite Image(uint32_t binding, VkDescriptorType, VkImageView, VkSampler,
+                                     VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        bool operator==(const DescriptorWrite&) const;
+    };
+
+    ///writes every descriptor with a single vkUpdateDescriptorSets
+    void WriteDescriptors(VkDevice, VkDescriptorSet, std::span<const DescriptorWrite>);
+
+    ///owns descriptor set layouts and immutable descriptor sets, both deduplicated by content.
+    ///Asking for the same bindings twice returns the same layout, asking for the same layout and
+    ///descriptors twice returns the same set, allocated and written once
+    class DescriptorCache
+    {
+        public:
+            struct Stats
+            {
+                uint32_t layouts{0};
+                uint32_t layoutHits{0};
+                uint32_t sets{0};
+                uint32_t setHits{0};
+                uint32_t evicted{0};
+            };
+
+            DescriptorCache() = default;
+
+            void Create(VkDevice, std::span<const DescriptorRatio> ratios);
+            void Delete();
+
+            ///immutable samplers are not supported, bindingFlags is either empty or one entry per binding
+            VkDescriptorSetLayout Layout(std::span<const VkDescriptorSetLayoutBinding> bindings,
+                                         VkDescriptorSetLayoutCreateFlags flags = 0,
+                                         std::span<const VkDescriptorBindingFlags> bindingFlags = {});
+
+            ///sets are never rewritten, changed resources make a different set
+            VkDescriptorSet Set(VkDescriptorSetLayout, std::span<const DescriptorWrite>);
+
+            ///frees every set referencing the view, none of them may be bound by a frame in flight anymore
+            void EvictImageView(VkImageView);
+
+            Stats stats() const { return _stats; }
+            void PrintStats() const;
+
+        private:
+            struct LayoutEntry
+            {
+                std::vector<VkDescriptorSetLayoutBinding> bindings;
+                VkDescriptorSetLayoutCreateFlags flags;
+                std::vector<VkDescriptorBindingFlags> bindingFlags;
+                VkDescriptorSetLayout layout;
+            };
+
+            struct SetEntry
+            {
+                VkDescriptorSetLayout layout;
+                std::vector<DescriptorWrite> writes;
+                VkDescriptorSet set;
+                VkDescriptorPool pool;
+            };
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            ///keyed by content hash, collisions share a bucket and are told apart by comparing the content
+            std::unordered_multimap<uint64_t, LayoutEntry> _layouts;
+            std::unordered_multimap<uint64_t, SetEntry> _sets;
+            DescriptorAllocator _allocator; ///created with FREE_DESCRIPTOR_SET so evicted sets go back to their pool
+            Stats _stats{};
+    };
+}
+
+#endif
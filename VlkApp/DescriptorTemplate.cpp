@@ -0,0 +1,107 @@
+#include "DescriptorTemplate.h"
+#include "DescriptorCache.h"
+#include "errLog.h"
+
+using namespace VulkanTut;
+
+std::vector<VkDescriptorSetLayoutBinding> VulkanTut::LayoutBindings(std::span<const DescriptorField> fields)
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings(fields.size());
+    for(size_t i{0}; i<fields.size(); ++i)
+    {
+        bindings[i].binding = fields[i].binding;
+        bindings[i].descriptorType = fields[i].type;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = fields[i].stages;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    return bindings;
+}
+
+bool DescriptorTemplate::Create(VkDevice device, VkDescriptorSetLayout layout, std::span<const DescriptorField> fields)
+{
+    _device = device;
+
+    VkDescriptorUpdateTemplateCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    createInfo.descriptorSetLayout = layout;
+
+    return CreateTemplate(createInfo, fields);
+}
+
+bool DescriptorTemplate::CreatePush(VkDevice device, std::span<const DescriptorField> fields, VkPipelineBindPoint bindPoint,
+                                    VkPipelineLayout pipelineLayout, uint32_t set)
+{
+    _device = device;
+
+    _pushWithTemplate = reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(
+            vkGetDeviceProcAddr(_device, "vkCmdPushDescriptorSetWithTemplateKHR"));
+    if(_pushWithTemplate == nullptr)
+    {
+        LOG("vkCmdPushDescriptorSetWithTemplateKHR missing, was VK_KHR_push_descriptor enabled?");
+        return false;
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+    createInfo.pipelineBindPoint = bindPoint;
+    createInfo.pipelineLayout = pipelineLayout;
+    createInfo.set = set;
+
+    if(!CreateTemplate(createInfo, fields))
+        return false;
+
+    _pushLayout = pipelineLayout;
+    _pushSet = set;
+
+    return true;
+}
+
+bool DescriptorTemplate::CreateTemplate(const VkDescriptorUpdateTemplateCreateInfo& info, std::span<const DescriptorField> fields)
+{
+    std::vector<VkDescriptorUpdateTemplateEntry> entries(fields.size());
+    for(size_t i{0}; i<fields.size(); ++i)
+    {
+        entries[i].dstBinding = fields[i].binding;
+        entries[i].dstArrayElement = 0;
+        entries[i].descriptorCount = 1;
+        entries[i].descriptorType = fields[i].type;
+        entries[i].offset = fields[i].offset;
+        entries[i].stride = IsImageDescriptor(fields[i].type) ? sizeof(VkDescriptorImageInfo) : sizeof(VkDescriptorBufferInfo);
+    }
+
+    auto createInfo = info;
+    createInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+    createInfo.pDescriptorUpdateEntries = entries.data();
+
+    if(vkCreateDescriptorUpdateTemplate(_device, &createInfo, nullptr, &_template) != VK_SUCCESS)
+    {
+        LOG_ARGS("descriptor update template creation failed, {} bindings", fields.size());
+        _template = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+void DescriptorTemplate::Delete()
+{
+    if(_template != VK_NULL_HANDLE)
+        vkDestroyDescriptorUpdateTemplate(_device, _template, nullptr);
+
+    _template = VK_NULL_HANDLE;
+    _pushLayout = VK_NULL_HANDLE;
+}
+
+void DescriptorTemplate::UpdateRaw(VkDescriptorSet set, const void* data) const
+{
+    vkUpdateDescriptorSetWithTemplate(_device, set, _template, data);
+}
+
+void DescriptorTemplate::PushRaw(VkCommandBuffer cmdBuff, const void* data) const
+{
+    _pushWithTemplate(cmdBuff, _template, _pushLayout, _pushSet, data);
+}
@@ -0,0 +1,81 @@
+#ifndef VULKANTUT2_DESCRIPTORTEMPLATE_H
+#define VULKANTUT2_DESCRIPTORTEMPLATE_H
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace VulkanTut
+{
+    ///one binding of a set described by the struct its descriptors are written from,
+    ///offset is offsetof the member holding the binding's VkDescriptorBufferInfo / VkDescriptorImageInfo
+    struct DescriptorField
+    {
+        uint32_t binding;
+        VkDescriptorType type;
+        VkShaderStageFlags stages;
+        size_t offset;
+    };
+
+    ///layout bindings of the description, one descriptor each
+    std::vector<VkDescriptorSetLayoutBinding> LayoutBindings(std::span<const DescriptorField>);
+
+    ///VkDescriptorUpdateTemplate generated from a description, every descriptor of a set is written
+    ///in one call straight out of a packed struct instead of through VkWriteDescriptorSet arrays.
+    ///The push form records the descriptors into the command buffer (VK_KHR_push_descriptor), no set is allocated
+    class DescriptorTemplate
+    {
+        public:
+            DescriptorTemplate() = default;
+
+            bool Create(VkDevice, VkDescriptorSetLayout, std::span<const DescriptorField>);
+            ///layout's set must have been created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
+            bool CreatePush(VkDevice, std::span<const DescriptorField>, VkPipelineBindPoint, VkPipelineLayout, uint32_t set);
+            void Delete();
+
+            template<typename Descriptors>
+            void Update(VkDescriptorSet set, const Descriptors& descriptors) const
+            {
+                static_assert(std::is_trivially_copyable_v<Descriptors> && !std::is_pointer_v<Descriptors>,
+                              "descriptors are read as raw memory at the description's offsets");
+                UpdateRaw(set, &descriptors);
+            }
+
+            ///sets[i] from descriptors[i]
+            template<typename Descriptors>
+            void Update(std::span<const VkDescriptorSet> sets, std::span<const Descriptors> descriptors) const
+            {
+                for(size_t i{0}; i<sets.size() && i<descriptors.size(); ++i)
+                    Update(sets[i], descriptors[i]);
+            }
+
+            template<typename Descriptors>
+            void Push(VkCommandBuffer cmdBuff, const Descriptors& descriptors) const
+            {
+                static_assert(std::is_trivially_copyable_v<Descriptors> && !std::is_pointer_v<Descriptors>,
+                              "descriptors are read as raw memory at the description's offsets");
+                PushRaw(cmdBuff, &descriptors);
+            }
+
+            auto isPush() const { return _pushLayout != VK_NULL_HANDLE; }
+            auto valid() const { return _template != VK_NULL_HANDLE; }
+
+        private:
+            bool CreateTemplate(const VkDescriptorUpdateTemplateCreateInfo&, std::span<const DescriptorField>);
+            void UpdateRaw(VkDescriptorSet, const void* data) const;
+            void PushRaw(VkCommandBuffer, const void* data) const;
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            VkDescriptorUpdateTemplate _template{VK_NULL_HANDLE};
+            ///push form only
+            VkPipelineLayout _pushLayout{VK_NULL_HANDLE};
+            uint32_t _pushSet{0};
+            PFN_vkCmdPushDescriptorSetWithTemplateKHR _pushWithTemplate{nullptr};
+    };
+}
+
+#endif
@@ -0,0 +1,563 @@
+#include "DeviceAllocator.h"
+#include "errLog.h"
+#include <bit>
+#include <algorithm>
+
+using namespace VulkanTut;
+
+///TLSF (two level segregated fit) bookkeeping, first level is log2 of the size,
+///second level splits every power of two range into SL_COUNT linear classes
+static constexpr uint32_t SL_BITS{4};
+static constexpr uint32_t SL_COUNT{1u << SL_BITS};
+static constexpr uint32_t FL_COUNT{64 - SL_BITS + 1};
+static constexpr VkDeviceSize SMALL_SIZE{SL_COUNT};
+static constexpr VkDeviceSize MIN_SPLIT_SIZE{256};
+
+struct VulkanTut::MemoryChunk
+{
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+    bool free{true};
+
+    MemoryChunk* prevPhys{nullptr};
+    MemoryChunk* nextPhys{nullptr};
+    MemoryChunk* prevFree{nullptr};
+    MemoryChunk* nextFree{nullptr};
+};
+
+struct VulkanTut::MemoryBlock
+{
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkDeviceSize size{0};
+    VkDeviceSize used{0};
+    uint32_t allocationCount{0};
+    uint32_t memType{0};
+    void* mapped{nullptr};
+
+    MemoryChunk* first{nullptr};
+    uint64_t flBitmap{0};
+    std::array<uint32_t, FL_COUNT> slBitmaps{};
+    std::array<std::array<MemoryChunk*, SL_COUNT>, FL_COUNT> freeLists{};
+};
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void Mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+{
+    if(size < SMALL_SIZE)
+    {
+        fl = 0;
+        sl = static_cast<uint32_t>(size);
+    }
+    else
+    {
+        auto msb = static_cast<uint32_t>(63 - std::countl_zero(size));
+        sl = static_cast<uint32_t>(size >> (msb - SL_BITS)) ^ SL_COUNT;
+        fl = msb - SL_BITS + 1;
+    }
+}
+
+///rounds the size up to the next class so every chunk of the found list is big enough
+static void MappingSearch(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+{
+    if(size >= SMALL_SIZE)
+    {
+        auto msb = static_cast<uint32_t>(63 - std::countl_zero(size));
+        size += (VkDeviceSize{1} << (msb - SL_BITS)) - 1;
+    }
+
+    Mapping(size, fl, sl);
+}
+
+static void InsertFree(MemoryBlock& block, MemoryChunk* chunk)
+{
+    uint32_t fl, sl;
+    Mapping(chunk->size, fl, sl);
+
+    auto*& head = block.freeLists[fl][sl];
+    chunk->free = true;
+    chunk->prevFree = nullptr;
+    chunk->nextFree = head;
+    if(head)
+        head->prevFree = chunk;
+    head = chunk;
+
+    block.flBitmap |= uint64_t{1} << fl;
+    block.slBitmaps[fl] |= 1u << sl;
+}
+
+static void RemoveFree(MemoryBlock& block, MemoryChunk* chunk)
+{
+    uint32_t fl, sl;
+    Mapping(chunk->size, fl, sl);
+
+    if(chunk->prevFree)
+        chunk->prevFree->nextFree = chunk->nextFree;
+    else
+        block.freeLists[fl][sl] = chunk->nextFree;
+
+    if(chunk->nextFree)
+        chunk->nextFree->prevFree = chunk->prevFree;
+
+    chunk->prevFree = chunk->nextFree = nullptr;
+
+    if(!block.freeLists[fl][sl])
+    {
+        block.slBitmaps[fl] &= ~(1u << sl);
+        if(!block.slBitmaps[fl])
+            block.flBitmap &= ~(uint64_t{1} << fl);
+    }
+}
+
+static MemoryChunk* FindFree(const MemoryBlock& block, VkDeviceSize size)
+{
+    uint32_t fl, sl;
+    MappingSearch(size, fl, sl);
+
+    if(fl >= FL_COUNT)
+        return nullptr;
+
+    auto slMap = block.slBitmaps[fl] & (~0u << sl);
+    if(!slMap)
+    {
+        auto flMap = fl + 1 < 64 ? block.flBitmap & (~uint64_t{0} << (fl + 1)) : 0;
+        if(!flMap)
+            return nullptr;
+
+        fl = static_cast<uint32_t>(std::countr_zero(flMap));
+        slMap = block.slBitmaps[fl];
+    }
+
+    sl = static_cast<uint32_t>(std::countr_zero(slMap));
+
+    return block.freeLists[fl][sl];
+}
+
+static MemoryChunk* AllocateFromBlock(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment)
+{
+    auto* chunk = FindFree(block, size + alignment - 1);
+    if(!chunk)
+        return nullptr;
+
+    RemoveFree(block, chunk);
+
+    ///leading padding becomes its own free chunk
+    auto alignedOffset = AlignUp(chunk->offset, alignment);
+    if(auto pad = alignedOffset - chunk->offset; pad)
+    {
+        auto* front = new MemoryChunk{chunk->offset, pad, true, chunk->prevPhys, chunk};
+        if(chunk->prevPhys)
+            chunk->prevPhys->nextPhys = front;
+        else
+            block.first = front;
+
+        chunk->prevPhys = front;
+        chunk->offset = alignedOffset;
+        chunk->size -= pad;
+        InsertFree(block, front);
+    }
+
+    if(chunk->size - size >= MIN_SPLIT_SIZE)
+    {
+        auto* tail = new MemoryChunk{chunk->offset + size, chunk->size - size, true, chunk, chunk->nextPhys};
+        if(chunk->nextPhys)
+            chunk->nextPhys->prevPhys = tail;
+
+        chunk->nextPhys = tail;
+        chunk->size = size;
+        InsertFree(block, tail);
+    }
+
+    chunk->free = false;
+    block.used += chunk->size;
+    ++block.allocationCount;
+
+    return chunk;
+}
+
+static void FreeToBlock(MemoryBlock& block, MemoryChunk* chunk)
+{
+    block.used -= chunk->size;
+    --block.allocationCount;
+
+    if(auto* prev = chunk->prevPhys; prev && prev->free)
+    {
+        RemoveFree(block, prev);
+        prev->size += chunk->size;
+        prev->nextPhys = chunk->nextPhys;
+        if(chunk->nextPhys)
+            chunk->nextPhys->prevPhys = prev;
+
+        delete chunk;
+        chunk = prev;
+    }
+
+    if(auto* next = chunk->nextPhys; next && next->free)
+    {
+        RemoveFree(block, next);
+        chunk->size += next->size;
+        chunk->nextPhys = next->nextPhys;
+        if(next->nextPhys)
+            next->nextPhys->prevPhys = chunk;
+
+        delete next;
+    }
+
+    InsertFree(block, chunk);
+}
+
+static VkDeviceSize LargestFree(const MemoryBlock& block)
+{
+    if(!block.flBitmap)
+        return 0;
+
+    auto fl = static_cast<uint32_t>(63 - std::countl_zero(block.flBitmap));
+    auto sl = static_cast<uint32_t>(31 - std::countl_zero(block.slBitmaps[fl]));
+
+    VkDeviceSize largest{0};
+    for(auto* chunk = block.freeLists[fl][sl]; chunk; chunk = chunk->nextFree)
+        largest = std::max(largest, chunk->size);
+
+    return largest;
+}
+
+void DeviceAllocator::Create(VkDevice device, VkPhysicalDevice pDevice, VkDeviceSize preferredBlockSize)
+{
+    _device = device;
+    _pDevice = pDevice;
+    _preferredBlockSize = preferredBlockSize;
+
+    vkGetPhysicalDeviceMemoryProperties(_pDevice, &_memProps);
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_pDevice, &properties);
+    _bufferImageGranularity = properties.limits.bufferImageGranularity;
+    _maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+}
+
+void DeviceAllocator::Delete()
+{
+    std::lock_guard lock(_mutex);
+
+    for(auto& pools : _pools)
+        for(auto& pool : pools)
+        {
+            for(auto* block : pool)
+                DestroyBlock(block);
+
+            pool.clear();
+        }
+}
+
+uint32_t DeviceAllocator::FindMemType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for(uint32_t i{0}; i<_memProps.memoryTypeCount; ++i)
+        if((typeFilter & (1 << i)) && (_memProps.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+
+    LOG("no suitable memory type was found");
+    return UINT32_MAX;
+}
+
+VkDeviceSize DeviceAllocator::BlockSizeFor(uint32_t memType) const
+{
+    const auto heapSize = _memProps.memoryHeaps[_memProps.memoryTypes[memType].heapIndex].size;
+
+    ///small heaps (e.g. 256MB BAR) would be exhausted by a few default sized blocks
+    return std::min(_preferredBlockSize, std::max<VkDeviceSize>(heapSize / 8, 1024 * 1024));
+}
+
+MemoryBlock* DeviceAllocator::CreateBlock(uint32_t memType, ResourceKind kind, VkDeviceSize size)
+{
+    if(_vkAllocationCount >= _maxAllocationCount)
+    {
+        LOG_ARGS("maxMemoryAllocationCount ({}) reached", _maxAllocationCount);
+        return nullptr;
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memType;
+
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    if(vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+    {
+        LOG_ARGS("allocation of {} byte block of memory type {} failed", size, memType);
+        return nullptr;
+    }
+
+    ++_vkAllocationCount;
+
+    auto* block = new MemoryBlock{};
+    block->memory = memory;
+    block->size = size;
+    block->memType = memType;
+
+    if(_memProps.memoryTypes[memType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, &block->mapped);
+
+    block->first = new MemoryChunk{0, size};
+    InsertFree(*block, block->first);
+
+    _pools[memType][PoolIndex(kind)].push_back(block);
+
+    return block;
+}
+
+void DeviceAllocator::DestroyBlock(MemoryBlock* block)
+{
+    for(auto* chunk = block->first; chunk;)
+    {
+        auto* next = chunk->nextPhys;
+        delete chunk;
+        chunk = next;
+    }
+
+    if(block->mapped)
+        vkUnmapMemory(_device, block->memory);
+
+    vkFreeMemory(_device, block->memory, nullptr);
+    --_vkAllocationCount;
+
+    delete block;
+}
+
+Allocation DeviceAllocator::AllocateDedicated(const VkMemoryRequirements& requirements, uint32_t memType)
+{
+    Allocation allocation{};
+
+    if(_vkAllocationCount >= _maxAllocationCount)
+    {
+        LOG_ARGS("maxMemoryAllocationCount ({}) reached", _maxAllocationCount);
+        return allocation;
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = memType;
+
+    if(vkAllocateMemory(_device, &allocInfo, nullptr, &allocation.memory) != VK_SUCCESS)
+    {
+        LOG_ARGS("dedicated allocation of {} bytes failed", requirements.size);
+        return allocation;
+    }
+
+    ++_vkAllocationCount;
+    ++_dedicatedCount[memType];
+    _dedicatedBytes[memType] += requirements.size;
+
+    allocation.size = requirements.size;
+    allocation.memType = memType;
+
+    if(_memProps.memoryTypes[memType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(_device, allocation.memory, 0, VK_WHOLE_SIZE, 0, &allocation.mapped);
+
+    return allocation;
+}
+
+Allocation DeviceAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind)
+{
+    std::lock_guard lock(_mutex);
+
+    auto memType = FindMemType(requirements.memoryTypeBits, properties);
+    if(memType == UINT32_MAX)
+        return {};
+
+    const auto blockSize = BlockSizeFor(memType);
+    if(requirements.size > blockSize / 2)
+        return AllocateDedicated(requirements, memType);
+
+    auto makeAllocation = [&](MemoryBlock* block, MemoryChunk* chunk){
+        Allocation allocation{};
+        allocation.memory = block->memory;
+        allocation.offset = chunk->offset;
+        allocation.size = requirements.size;
+        allocation.mapped = block->mapped ? static_cast<char*>(block->mapped) + chunk->offset : nullptr;
+        allocation.block = block;
+        allocation.chunk = chunk;
+        allocation.memType = memType;
+
+        return allocation;
+    };
+
+    for(auto* block : _pools[memType][PoolIndex(kind)])
+        if(auto* chunk = AllocateFromBlock(*block, requirements.size, requirements.alignment))
+            return makeAllocation(block, chunk);
+
+    auto* block = CreateBlock(memType, kind, blockSize);
+    if(!block)
+        return AllocateDedicated(requirements, memType);
+
+    return makeAllocation(block, AllocateFromBlock(*block, requirements.size, requirements.alignment));
+}
+
+void DeviceAllocator::Free(const Allocation& allocation)
+{
+    if(allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard lock(_mutex);
+
+    if(!allocation.block)
+    {
+        if(allocation.mapped)
+            vkUnmapMemory(_device, allocation.memory);
+
+        vkFreeMemory(_device, allocation.memory, nullptr);
+        --_vkAllocationCount;
+        --_dedicatedCount[allocation.memType];
+        _dedicatedBytes[allocation.memType] -= allocation.size;
+        return;
+    }
+
+    auto* block = allocation.block;
+    FreeToBlock(*block, allocation.chunk);
+
+    ///keep one empty block per pool around so alloc/free cycles don't thrash vkAllocateMemory
+    if(!block->allocationCount)
+        for(auto& pool : _pools[block->memType])
+        {
+            auto it = std::find(pool.begin(), pool.end(), block);
+            if(it != pool.end() && pool.size() > 1)
+            {
+                pool.erase(it);
+                DestroyBlock(block);
+                break;
+            }
+        }
+}
+
+std::tuple<VkBuffer, Allocation>
+DeviceAllocator::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkSharingMode mode)
+{
+    VkBuffer buff{VK_NULL_HANDLE};
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = mode;
+
+    if(vkCreateBuffer(_device, &bufferInfo, nullptr, &buff) != VK_SUCCESS)
+    {
+        LOG("creation of buffer failed");
+        return {VK_NULL_HANDLE, Allocation{}};
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(_device, buff, &memRequirements);
+
+    auto allocation = Allocate(memRequirements, properties, ResourceKind::Linear);
+    if(allocation.memory == VK_NULL_HANDLE)
+    {
+        LOG_ARGS("allocation of {} bytes of buffer memory failed", memRequirements.size);
+        vkDestroyBuffer(_device, buff, nullptr);
+        return {VK_NULL_HANDLE, Allocation{}};
+    }
+
+    vkBindBufferMemory(_device, buff, allocation.memory, allocation.offset);
+
+    return {buff, allocation};
+}
+
+std::tuple<VkImage, Allocation>
+DeviceAllocator::CreateImage(const VkImageCreateInfo& imgInfo, VkMemoryPropertyFlags properties)
+{
+    VkImage image{VK_NULL_HANDLE};
+
+    if(vkCreateImage(_device, &imgInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        LOG("creation of image failed");
+        return {VK_NULL_HANDLE, Allocation{}};
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(_device, image, &memRequirements);
+
+    auto kind = imgInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceKind::Optimal : ResourceKind::Linear;
+    auto allocation = Allocate(memRequirements, properties, kind);
+    if(allocation.memory == VK_NULL_HANDLE)
+    {
+        LOG_ARGS("allocation of {} bytes of image memory failed", memRequirements.size);
+        vkDestroyImage(_device, image, nullptr);
+        return {VK_NULL_HANDLE, Allocation{}};
+    }
+
+    vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+
+    return {image, allocation};
+}
+
+void DeviceAllocator::DestroyBuffer(VkBuffer buff, const Allocation& allocation)
+{
+    vkDestroyBuffer(_device, buff, nullptr);
+    Free(allocation);
+}
+
+void DeviceAllocator::DestroyImage(VkImage image, const Allocation& allocation)
+{
+    vkDestroyImage(_device, image, nullptr);
+    Free(allocation);
+}
+
+std::vector<HeapStats> DeviceAllocator::GetHeapStats() const
+{
+    std::lock_guard lock(_mutex);
+
+    std::vector<HeapStats> stats(_memProps.memoryHeapCount);
+    std::vector<VkDeviceSize> freeBytes(_memProps.memoryHeapCount, 0);
+    std::vector<VkDeviceSize> contiguousBytes(_memProps.memoryHeapCount, 0);
+
+    for(uint32_t i{0}; i<_memProps.memoryHeapCount; ++i)
+        stats[i].heapSize = _memProps.memoryHeaps[i].size;
+
+    for(uint32_t type{0}; type<_memProps.memoryTypeCount; ++type)
+    {
+        auto& heap = stats[_memProps.memoryTypes[type].heapIndex];
+        auto& heapFree = freeBytes[_memProps.memoryTypes[type].heapIndex];
+        auto& heapContiguous = contiguousBytes[_memProps.memoryTypes[type].heapIndex];
+
+        for(const auto& pool : _pools[type])
+            for(const auto* block : pool)
+            {
+                ++heap.blockCount;
+                heap.reserved += block->size;
+                heap.used += block->used;
+                heap.allocationCount += block->allocationCount;
+                const auto largest = LargestFree(*block);
+                heap.largestFree = std::max(heap.largestFree, largest);
+                heapContiguous += largest;
+                heapFree += block->size - block->used;
+            }
+
+        heap.dedicatedCount += _dedicatedCount[type];
+        heap.allocationCount += _dedicatedCount[type];
+        heap.reserved += _dedicatedBytes[type];
+        heap.used += _dedicatedBytes[type];
+    }
+
+    for(uint32_t i{0}; i<_memProps.memoryHeapCount; ++i)
+        if(freeBytes[i])
+            stats[i].fragmentation = 1.f - static_cast<float>(contiguousBytes[i]) / static_cast<float>(freeBytes[i]);
+
+    return stats;
+}
+
+void DeviceAllocator::PrintStats() const
+{
+    auto stats = GetHeapStats();
+
+    for(size_t i{0}; i<stats.size(); ++i)
+    {
+        const auto& heap = stats[i];
+        fmt::print("| heap {} | size {} MiB | reserved {} KiB in {} blocks + {} dedicated | used {} KiB by {} allocations | "
+                   "largest free {} KiB | fragmentation {:.1f}% |\n",
+                   i, heap.heapSize >> 20, heap.reserved >> 10, heap.blockCount, heap.dedicatedCount,
+                   heap.used >> 10, heap.allocationCount, heap.largestFree >> 10, heap.fragmentation * 100.f);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef VULKANTUT2_DEVICEALLOCATOR_H
+#define VULKANTUT2_DEVICEALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <tuple>
+#include <vector>
+#include <array>
+#include <mutex>
+
+namespace VulkanTut
+{
+    struct MemoryBlock;
+    struct MemoryChunk;
+
+    ///linear resources (buffers, linear images) and optimal images are kept in separate blocks
+    ///whenever bufferImageGranularity > 1, so neighbouring sub-allocations can never alias a page
+    enum class ResourceKind
+    {
+        Linear,
+        Optimal
+    };
+
+    struct Allocation
+    {
+        VkDeviceMemory memory{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+        VkDeviceSize size{0};
+        void* mapped{nullptr}; ///persistent host pointer (already offset), only for host visible types
+
+        MemoryBlock* block{nullptr}; ///nullptr for dedicated allocations
+        MemoryChunk* chunk{nullptr};
+        uint32_t memType{UINT32_MAX};
+    };
+
+    struct HeapStats
+    {
+        VkDeviceSize heapSize{0};
+        VkDeviceSize reserved{0};    ///bytes held by vkAllocateMemory (blocks + dedicated)
+        VkDeviceSize used{0};        ///bytes handed out to resources
+        VkDeviceSize largestFree{0}; ///largest free range inside a single block
+        uint32_t blockCount{0};
+        uint32_t dedicatedCount{0};
+        uint32_t allocationCount{0};
+        float fragmentation{.0f};    ///1 - sum(largest free per block) / freeBytes, 0 means every block's free space is contiguous
+    };
+
+    class DeviceAllocator
+    {
+        public:
+            DeviceAllocator() = default;
+
+            void Create(VkDevice, VkPhysicalDevice, VkDeviceSize preferredBlockSize = DefaultBlockSize);
+            void Delete();
+
+            Allocation Allocate(const VkMemoryRequirements&, VkMemoryPropertyFlags, ResourceKind);
+            void Free(const Allocation&);
+
+            std::tuple<VkBuffer, Allocation> CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags, VkSharingMode = VK_SHARING_MODE_EXCLUSIVE);
+            std::tuple<VkImage, Allocation> CreateImage(const VkImageCreateInfo&, VkMemoryPropertyFlags);
+            void DestroyBuffer(VkBuffer, const Allocation&);
+            void DestroyImage(VkImage, const Allocation&);
+
+            uint32_t FindMemType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+            std::vector<HeapStats> GetHeapStats() const;
+            void PrintStats() const;
+
+            static constexpr VkDeviceSize DefaultBlockSize{64ull * 1024 * 1024};
+
+        private:
+            MemoryBlock* CreateBlock(uint32_t memType, ResourceKind, VkDeviceSize size);
+            void DestroyBlock(MemoryBlock*);
+            Allocation AllocateDedicated(const VkMemoryRequirements&, uint32_t memType);
+            VkDeviceSize BlockSizeFor(uint32_t memType) const;
+            uint32_t PoolIndex(ResourceKind kind) const { return (_bufferImageGranularity > 1 && kind == ResourceKind::Optimal) ? 1 : 0; }
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            VkPhysicalDevice _pDevice{VK_NULL_HANDLE};
+            VkPhysicalDeviceMemoryProperties _memProps{};
+            VkDeviceSize _preferredBlockSize{DefaultBlockSize};
+            VkDeviceSize _bufferImageGranularity{1};
+            uint32_t _maxAllocationCount{0};
+
+            ///blocks per memory type, [0] linear, [1] optimal (only used when granularity > 1)
+            std::array<std::array<std::vector<MemoryBlock*>, 2>, VK_MAX_MEMORY_TYPES> _pools{};
+            std::array<VkDeviceSize, VK_MAX_MEMORY_TYPES> _dedicatedBytes{};
+            std::array<uint32_t, VK_MAX_MEMORY_TYPES> _dedicatedCount{};
+            uint32_t _vkAllocationCount{0};
+
+            mutable std::mutex _mutex;
+    };
+}
+
+#endif
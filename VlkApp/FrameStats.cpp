@@ -0,0 +1,141 @@
+#include "FrameStats.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <limits>
+
+using namespace VulkanTut;
+
+FrameStats::FrameStats(size_t capacity)
+    : _samples(std::max<size_t>(capacity, 1))
+{
+}
+
+void FrameStats::BeginFrame()
+{
+    _current.frame = _frame;
+    _current.ms.fill(std::numeric_limits<double>::quiet_NaN());
+}
+
+void FrameStats::EndFrame()
+{
+    _samples[_head] = _current;
+    _head = (_head + 1) % _samples.size();
+    _count = std::min(_count + 1, _samples.size());
+    ++_frame;
+}
+
+FrameStats::Summary FrameStats::Summarize(FrameStage stage) const
+{
+    Summary summary{};
+
+    std::vector<double> values;
+    values.reserve(_count);
+    ForEach([&](const Sample& sample){
+        const auto ms = sample.ms[static_cast<size_t>(stage)];
+        if(!std::isnan(ms))
+            values.push_back(ms);
+    });
+
+    if(values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+
+    ///nearest rank
+    auto percentile = [&](double p){
+        auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+
+    double sum{.0};
+    for(auto v : values)
+        sum += v;
+
+    summary.mean = sum / static_cast<double>(values.size());
+    summary.p50 = percentile(.50);
+    summary.p95 = percentile(.95);
+    summary.p99 = percentile(.99);
+    summary.max = values.back();
+    summary.count = values.size();
+
+    return summary;
+}
+
+void FrameStats::Print() const
+{
+    fmt::print("| frame stats | last {} of {} frames | ms |\n", _count, _frame);
+
+    for(size_t i{0}; i<StageNames.size(); ++i)
+    {
+        auto s = Summarize(static_cast<FrameStage>(i));
+        fmt::print("| {:<10} | mean {:8.4f} | p50 {:8.4f} | p95 {:8.4f} | p99 {:8.4f} | max {:8.4f} | n {} |\n",
+                   StageNames[i], s.mean, s.p50, s.p95, s.p99, s.max, s.count);
+    }
+}
+
+bool FrameStats::Export(std::string_view path) const
+{
+    if(path.ends_with(".json"))
+        return ExportJSON(path);
+
+    return ExportCSV(path);
+}
+
+bool FrameStats::ExportCSV(std::string_view path) const
+{
+    std::ofstream stream(std::string(path), std::ios::trunc);
+    if(!stream)
+    {
+        LOG_ARGS("could not open {} for writing", path);
+        return false;
+    }
+
+    stream << "frame";
+    for(auto name : StageNames)
+        stream << ',' << name << "_ms";
+    stream << '\n';
+
+    ForEach([&](const Sample& sample){
+        stream << sample.frame;
+        for(auto ms : sample.ms)
+            stream << (std::isnan(ms) ? std::string(",") : fmt::format(",{:.6f}", ms));
+        stream << '\n';
+    });
+
+    return static_cast<bool>(stream);
+}
+
+bool FrameStats::ExportJSON(std::string_view path) const
+{
+    std::ofstream stream(std::string(path), std::ios::trunc);
+    if(!stream)
+    {
+        LOG_ARGS("could not open {} for writing", path);
+        return false;
+    }
+
+    stream << fmt::format("{{\n  \"frames\": {},\n  \"window\": {},\n  \"summary\": {{\n", _frame, _count);
+    for(size_t i{0}; i<StageNames.size(); ++i)
+    {
+        auto s = Summarize(static_cast<FrameStage>(i));
+        stream << fmt::format("    \"{}\": {{\"mean\": {:.6f}, \"p50\": {:.6f}, \"p95\": {:.6f}, \"p99\": {:.6f}, \"max\": {:.6f}, \"count\": {}}}{}\n",
+                              StageNames[i], s.mean, s.p50, s.p95, s.p99, s.max, s.count, i + 1 < StageNames.size() ? "," : "");
+    }
+    stream << "  },\n  \"samples\": [\n";
+
+    size_t written{0};
+    ForEach([&](const Sample& sample){
+        stream << fmt::format("    {{\"frame\": {}", sample.frame);
+        for(size_t i{0}; i<StageNames.size(); ++i)
+            stream << (std::isnan(sample.ms[i]) ? fmt::format(", \"{}\": null", StageNames[i])
+                                                : fmt::format(", \"{}\": {:.6f}", StageNames[i], sample.ms[i]));
+        stream << (++written < _count ? "},\n" : "}\n");
+    });
+
+    stream << "  ]\n}\n";
+
+    return static_cast<bool>(stream);
+}
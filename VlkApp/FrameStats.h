@@ -0,0 +1,96 @@
+#ifndef VULKANTUT2_FRAMESTATS_H
+#define VULKANTUT2_FRAMESTATS_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include <string_view>
+#include <cstdint>
+
+namespace VulkanTut
+{
+    enum class FrameStage : uint32_t
+    {
+        FrameWait,
+        Acquire,
+        Update,
+        Record,
+        Submit,
+        Present,
+        Gpu,    ///render pass time from timestamp queries, lags by frames in flight
+        Latency,///input sample (Update) to the frame observed retired, lags by frames in flight
+        Total,  ///cpu time of the whole DrawFrame call
+        Count
+    };
+
+    ///rolling window of per-frame stage timings (ms) with percentile summaries and CSV/JSON export.
+    ///Stages not Set in a frame (no gpu or latency reading yet, early return) are missing, not 0 ms,
+    ///summaries skip them and exports leave them empty
+    class FrameStats
+    {
+        struct Sample
+        {
+            uint64_t frame{0};
+            std::array<double, static_cast<size_t>(FrameStage::Count)> ms{}; ///NaN when missing
+        };
+
+        public:
+            struct Summary
+            {
+                double mean{.0};
+                double p50{.0};
+                double p95{.0};
+                double p99{.0};
+                double max{.0};
+                size_t count{0}; ///frames with a reading
+            };
+
+            explicit FrameStats(size_t capacity = DefaultCapacity);
+
+            void BeginFrame();
+            void Set(FrameStage stage, double ms) { _current.ms[static_cast<size_t>(stage)] = ms; }
+            void Add(FrameStage stage, double ms)
+            {
+                auto& current = _current.ms[static_cast<size_t>(stage)];
+                current = std::isnan(current) ? ms : current + ms;
+            }
+            void EndFrame();
+            ///drops the collected samples, frame numbering continues
+            void Reset() { _head = 0; _count = 0; }
+
+            Summary Summarize(FrameStage) const;
+            auto sampleCount() const { return _count; }
+            auto frameCount() const { return _frame; }
+
+            void Print() const;
+            ///format is chosen by extension (.json, anything else is CSV)
+            bool Export(std::string_view path) const;
+            bool ExportCSV(std::string_view path) const;
+            bool ExportJSON(std::string_view path) const;
+
+            static constexpr size_t DefaultCapacity{4096};
+            static constexpr std::array<std::string_view, static_cast<size_t>(FrameStage::Count)> StageNames
+            {
+                "frame_wait", "acquire", "update", "record", "submit", "present", "gpu", "latency", "total"
+            };
+
+        private:
+            ///samples oldest to newest
+            template<typename Fn>
+            void ForEach(Fn&& fn) const
+            {
+                const auto begin = (_head + _samples.size() - _count) % _samples.size();
+                for(size_t i{0}; i<_count; ++i)
+                    fn(_samples[(begin + i) % _samples.size()]);
+            }
+
+        private:
+            std::vector<Sample> _samples;
+            size_t _head{0};
+            size_t _count{0};
+            uint64_t _frame{0};
+            Sample _current{};
+    };
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef VULKANTUT2_HASH_H
+#define VULKANTUT2_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace VulkanTut
+{
+    static constexpr uint64_t Fnv1aBasis{0xcbf29ce484222325ull};
+
+    ///64 bit FNV-1a, seed chains hashes of several ranges
+    inline uint64_t Fnv1a(const void* data, size_t size, uint64_t seed = Fnv1aBasis)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash{seed};
+        for(size_t i{0}; i<size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    ///one little endian 32 bit word, constexpr so compile time descriptions can be hashed
+    constexpr uint64_t Fnv1aWord(uint32_t word, uint64_t seed = Fnv1aBasis)
+    {
+        uint64_t hash{seed};
+        for(uint32_t i{0}; i<4; ++i)
+        {
+            hash ^= (word >> (i * 8)) & 0xffu;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
+
+#endif
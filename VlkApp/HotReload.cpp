@@ -0,0 +1,101 @@
+#include "VlkApp.h"
+#include "errLog.h"
+
+#include <chrono>
+
+using namespace VulkanTut;
+
+void VlkApp::CreateShaderReloader(std::string_view compiler)
+{
+    ///stage paths never change, only the modules behind them, copies are safe to read from the reload thread
+    ///only the material variant in use is rebuilt eagerly, other cached variants are dropped and rebuilt on request
+    _shaderReloader.Create(compiler, [this, graphics = _program, cull = _cullProgram, material = _material](const std::string& spirv)
+    {
+        return RebuildPipelines(spirv, graphics, cull, material);
+    });
+}
+
+///reload thread, nothing here touches state the render thread writes except _renderPass (under _renderPassMutex)
+ShaderReloader::Completion VlkApp::RebuildPipelines(const std::string& spirv, const ShaderProgram& graphics, const ShaderProgram& cull,
+                                                    const PipelineState& material)
+{
+    const bool rebuildGraphics = graphics.uses(spirv);
+    const bool rebuildCull = _gpuDriven && cull.uses(spirv);
+
+    if(!rebuildGraphics && !rebuildCull)
+        return {};
+
+    ///a broken file keeps the running pipelines, the library already logged why
+    if(_shaderLibrary.Reload(spirv) == VK_NULL_HANDLE)
+        return {};
+
+    ShaderProgram program{};
+    VkPipeline pipeline{VK_NULL_HANDLE};
+    VkRenderPass renderPass{VK_NULL_HANDLE};
+    VkPipelineCreationFeedbackEXT feedback{};
+    double createMs{.0};
+
+    if(rebuildGraphics)
+    {
+        program = _shaderLibrary.Refresh(graphics);
+        if(program.valid())
+        {
+            std::lock_guard lock(_renderPassMutex);
+            renderPass = _renderPass;
+
+            auto beginTime = std::chrono::steady_clock::now();
+            pipeline = BuildGraphicsPipeline(program, renderPass, material, _pipelineFeedback ? &feedback : nullptr);
+            createMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count();
+        }
+    }
+
+    ShaderProgram cullProgram{};
+    VkPipeline cullPipeline{VK_NULL_HANDLE};
+
+    if(rebuildCull)
+    {
+        cullProgram = _shaderLibrary.Refresh(cull);
+        if(cullProgram.valid())
+            cullPipeline = BuildCullPipeline(cullProgram);
+    }
+
+    ///render thread, between frames
+    return [this, spirv, program, pipeline, renderPass, material, feedback, createMs, cullProgram, cullPipeline]()
+    {
+        if(pipeline != VK_NULL_HANDLE)
+        {
+            _pipelineCache.Record(_pipelineFeedback ? &feedback : nullptr, createMs);
+
+            auto current = pipeline;
+            ///the surface format changed while building, the render pass it was built against is retired
+            if(renderPass != _renderPass)
+            {
+                vkDestroyPipeline(_device, pipeline, nullptr);
+                current = BuildGraphicsPipeline(program, _renderPass, material, nullptr);
+            }
+
+            RetirePipelineVariants(_frameNumber);
+            _pipelineVariants.emplace(material, current);
+            _pipeline = current;
+            _program = program;
+        }
+
+        if(cullPipeline != VK_NULL_HANDLE)
+        {
+            RetirePipeline(_cullPipeline);
+            _cullPipeline = cullPipeline;
+            _cullProgram = cullProgram;
+        }
+
+        fmt::print("| shader reload | {} |\n", spirv);
+    };
+}
+
+void VlkApp::RetirePipeline(VkPipeline pipeline)
+{
+    ///recorded into frames still in flight
+    _deletionQueue.Push(_frameNumber, [this, pipeline]()
+    {
+        vkDestroyPipeline(_device, pipeline, nullptr);
+    });
+}
@@ -83,7 +83,8 @@ void VlkApp::CreateInstance(const std::vector<const char*>& instanceExtensions)
     appInfo.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
     appInfo.pEngineName = "no engine";
     appInfo.engineVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    ///1.1 for the features2/properties2 queries descriptor indexing needs, the rest stays 1.0 core
+    appInfo.apiVersion = VK_API_VERSION_1_1;
 
     ///instance info, here defining used extensions
     VkInstanceCreateInfo createInfo{};
@@ -0,0 +1,71 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include "VlkApp.h"
+#include "errLog.h"
+
+using namespace VulkanTut;
+
+void VlkApp::CreateInstances(uint32_t count)
+{
+    if(_instanceBuffer != VK_NULL_HANDLE)
+    {
+        ///every frame submitted so far may still read it
+        _deletionQueue.Push(_frameNumber, [this, buffer = _instanceBuffer, memory = _instanceMemory]()
+        {
+            _allocator.DestroyBuffer(buffer, memory);
+        });
+
+        _instanceBuffer = VK_NULL_HANDLE;
+        _instanceMemory = {};
+    }
+
+    _instanceCount = count;
+    if(!count)
+    {
+        if(_gpuDriven)
+            CreateCullingBuffers();
+        return;
+    }
+
+    ///side x side grid filling the area of a single quad, count == 1 yields the identity transform
+    const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const auto cell = 1.f / static_cast<float>(side);
+
+    std::vector<Quad::Instance> instances(count);
+    for(uint32_t i{0}; i<count; ++i)
+    {
+        const auto x = static_cast<float>(i % side);
+        const auto y = static_cast<float>(i / side);
+
+        auto model = glm::translate(glm::mat4(1.f), glm::vec3(-.5f + cell * (x + .5f), -.5f + cell * (y + .5f), .0f));
+        instances[i].model = glm::scale(model, glm::vec3(cell));
+        instances[i].texIndex = i % std::max(getTextureCount(), 1u); ///only read by the bindless fragment shader
+    }
+
+    const VkDeviceSize size = sizeof(Quad::Instance) * instances.size();
+
+    std::tie(_instanceBuffer, _instanceMemory) = _allocator.CreateBuffer(
+            size,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT|VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    if(_instanceBuffer == VK_NULL_HANDLE)
+    {
+        LOG_ARGS("instance buffer creation failed ({} instances)", count);
+        _instanceCount = 0;
+        return;
+    }
+
+    ///read as vertex input when drawn directly, as a storage buffer by the culling pass otherwise
+    _uploads.CopyToBuffer(instances.data(), size, _instanceBuffer, 0,
+                          VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT|VK_ACCESS_SHADER_READ_BIT,
+                          VK_PIPELINE_STAGE_VERTEX_INPUT_BIT|VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    if(_gpuDriven)
+        CreateCullingBuffers();
+}
@@ -0,0 +1,46 @@
+#ifndef VULKANTUT2_LATENCYPROFILE_H
+#define VULKANTUT2_LATENCYPROFILE_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace VulkanTut
+{
+    ///trades input to present latency against how well cpu and gpu work overlap
+    enum class LatencyProfile : uint32_t
+    {
+        LowLatency,    ///1 frame in flight, tearing allowed, shallowest swapchain
+        Balanced,      ///2 frames in flight, mailbox, min + 1 images
+        MaxThroughput, ///3 frames in flight, deeper swapchain keeps the gpu fed
+        Count
+    };
+
+    struct LatencyConfig
+    {
+        uint32_t framesInFlight;
+        ///first supported mode wins, FIFO (always supported) is the fallback
+        std::array<VkPresentModeKHR, 2> presentModes;
+        uint32_t extraSwapchainImages; ///on top of minImageCount
+    };
+
+    static constexpr std::array<LatencyConfig, static_cast<size_t>(LatencyProfile::Count)> LatencyConfigs
+    {{
+        {1, {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR}, 0},
+        {2, {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR}, 1},
+        {3, {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR}, 2}
+    }};
+
+    static constexpr std::array<std::string_view, static_cast<size_t>(LatencyProfile::Count)> LatencyProfileNames
+    {
+        "low-latency", "balanced", "max-throughput"
+    };
+
+    constexpr const LatencyConfig& GetLatencyConfig(LatencyProfile profile)
+    {
+        return LatencyConfigs[static_cast<size_t>(profile)];
+    }
+}
+
+#endif
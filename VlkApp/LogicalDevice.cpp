@@ -27,13 +27,59 @@ void VlkApp::CreateLogicalDevice(const std::vector<const char*>& deviceExtension
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+    ///block compressed families are enabled whenever present, CreateCompressedTexture checks the actual format
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedFeatures);
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+    deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+    ///optional, only reports whether pipelines came out of the pipeline cache
+    auto enabledExtensions = deviceExtensions;
+    _pipelineFeedback = CheckDeviceExtensionsSupport(_physicalDevice, {VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME});
+    if(_pipelineFeedback)
+        enabledExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+    ///optional, without it transient sets are allocated and written through a descriptor update template instead
+    _pushDescriptors = CheckDeviceExtensionsSupport(_physicalDevice, {VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME});
+    if(_pushDescriptors)
+        enabledExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+    ///required, IsDeviceSuitable rejected devices without it
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    if(_bindless && !CheckBindlessSupport())
+    {
+        LOG("descriptor indexing unsupported, bindless textures disabled");
+        _bindless = false;
+    }
+
+    if(_bindless)
+    {
+        indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
+    timelineFeatures.pNext = _bindless ? &indexingFeatures : nullptr;
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &timelineFeatures;
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.queueCreateInfoCount = queueCreateInfos.size();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = deviceExtensions.size();
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = enabledExtensions.size();
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if(EnableValidationLayers)
     {
@@ -0,0 +1,77 @@
+#include "MappedFile.h"
+#include "errLog.h"
+
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace VulkanTut;
+
+MappedFile::MappedFile(std::string_view path)
+{
+    const int fd = open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        LOG_ARGS("could not open {}", path);
+        return;
+    }
+
+    struct stat info{};
+    if(fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        LOG_ARGS("could not stat {} or it is empty", path);
+        close(fd);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ///the mapping keeps its own reference to the file
+    close(fd);
+
+    if(mapping == MAP_FAILED)
+    {
+        LOG_ARGS("could not map {}", path);
+        return;
+    }
+
+    ///read once front to back by the staging copy
+    madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+    _data = static_cast<const unsigned char*>(mapping);
+    _size = static_cast<size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        Unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+
+    return *this;
+}
+
+void MappedFile::Unmap()
+{
+    if(_data != nullptr)
+        munmap(const_cast<unsigned char*>(_data), _size);
+
+    _data = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,35 @@
+#ifndef VULKANTUT2_MAPPEDFILE_H
+#define VULKANTUT2_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace VulkanTut
+{
+    ///read only mmap of a whole file, pages are faulted in straight from the page cache on first touch
+    class MappedFile
+    {
+        public:
+            MappedFile() = default;
+            explicit MappedFile(std::string_view path);
+            ~MappedFile();
+
+            MappedFile(MappedFile&&) noexcept;
+            MappedFile& operator=(MappedFile&&) noexcept;
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            [[nodiscard]] bool valid() const { return _data != nullptr; }
+            [[nodiscard]] const unsigned char* data() const { return _data; }
+            [[nodiscard]] size_t size() const { return _size; }
+
+        private:
+            void Unmap();
+
+        private:
+            const unsigned char* _data{nullptr};
+            size_t _size{0};
+    };
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "MipGen.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define VULKANTUT2_MIPGEN_SSE2
+#endif
+
+using namespace VulkanTut;
+
+uint32_t VulkanTut::MipLevelCount(uint32_t w, uint32_t h)
+{
+    return std::bit_width(std::max({w, h, 1u}));
+}
+
+static void AverageTexel(const uint8_t* r0a, const uint8_t* r0b, const uint8_t* r1a, const uint8_t* r1b, uint8_t* dst)
+{
+    for(uint32_t c{0}; c<4; ++c)
+        dst[c] = static_cast<uint8_t>((r0a[c] + r0b[c] + r1a[c] + r1b[c] + 2) >> 2);
+}
+
+void VulkanTut::DownsampleRGBA8(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst)
+{
+    const auto dstW = std::max(w / 2, 1u);
+    const auto dstH = std::max(h / 2, 1u);
+
+    for(uint32_t y{0}; y<dstH; ++y)
+    {
+        const auto* row0 = src + static_cast<size_t>(std::min(2 * y, h - 1)) * w * 4;
+        const auto* row1 = src + static_cast<size_t>(std::min(2 * y + 1, h - 1)) * w * 4;
+        auto* out = dst + static_cast<size_t>(y) * dstW * 4;
+
+        uint32_t x{0};
+
+    #ifdef VULKANTUT2_MIPGEN_SSE2
+        ///2 output texels from 4 source texels of both rows per iteration, 16 bit sums can't overflow
+        if(w >= 2)
+        {
+            const auto zero = _mm_setzero_si128();
+            const auto round = _mm_set1_epi16(2);
+
+            for(; x + 1 < dstW; x += 2)
+            {
+                auto top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+                ///texels 0,1 and 2,3 of both rows summed per channel
+                auto lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                auto hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+                lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+                auto sum = _mm_unpacklo_epi64(lo, hi);
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, zero));
+            }
+        }
+    #endif
+
+        for(; x<dstW; ++x)
+        {
+            const auto x0 = std::min(2 * x, w - 1) * 4;
+            const auto x1 = std::min(2 * x + 1, w - 1) * 4;
+            AverageTexel(row0 + x0, row0 + x1, row1 + x0, row1 + x1, out + x * 4);
+        }
+    }
+}
+
+std::vector<ImageLevel> VulkanTut::MipChainLevelsRGBA8(uint32_t w, uint32_t h, uint32_t mipLevels)
+{
+    std::vector<ImageLevel> levels(mipLevels);
+
+    VkDeviceSize total{0};
+    for(uint32_t i{0}; i<mipLevels; ++i)
+    {
+        levels[i].offset = total;
+        levels[i].width = std::max(w >> i, 1u);
+        levels[i].height = std::max(h >> i, 1u);
+        total += static_cast<VkDeviceSize>(levels[i].width) * levels[i].height * 4;
+    }
+
+    return levels;
+}
+
+VkDeviceSize VulkanTut::MipChainSizeRGBA8(const std::vector<ImageLevel>& levels)
+{
+    if(levels.empty())
+        return 0;
+
+    return levels.back().offset + static_cast<VkDeviceSize>(levels.back().width) * levels.back().height * 4;
+}
+
+void VulkanTut::BuildMipChainRGBA8(const uint8_t* src, const std::vector<ImageLevel>& levels, uint8_t* out)
+{
+    if(levels.empty())
+        return;
+
+    std::memcpy(out, src, static_cast<size_t>(levels[0].width) * levels[0].height * 4);
+
+    if(levels.size() == 1)
+        return;
+
+    ///smaller levels are filtered in cached memory, each one read back from there for the next, then copied out
+    const auto tailOffset = levels[1].offset;
+    std::vector<uint8_t> tail(MipChainSizeRGBA8(levels) - tailOffset);
+
+    const uint8_t* prev = src;
+    for(size_t i{1}; i<levels.size(); ++i)
+    {
+        auto* dst = tail.data() + (levels[i].offset - tailOffset);
+        DownsampleRGBA8(prev, levels[i - 1].width, levels[i - 1].height, dst);
+        prev = dst;
+    }
+
+    std::memcpy(out + tailOffset, tail.data(), tail.size());
+}
@@ -0,0 +1,27 @@
+#ifndef VULKANTUT2_MIPGEN_H
+#define VULKANTUT2_MIPGEN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "UploadContext.h"
+
+namespace VulkanTut
+{
+    ///floor(log2(max(w, h))) + 1
+    uint32_t MipLevelCount(uint32_t w, uint32_t h);
+
+    ///2x2 box filter, dst is max(w / 2, 1) x max(h / 2, 1), odd edges clamp to the last texel.
+    ///Averages the stored values, for sRGB data that is slightly darker than a linear space blit
+    void DownsampleRGBA8(const uint8_t* src, uint32_t w, uint32_t h, uint8_t* dst);
+
+    ///placement of level 0 followed by every smaller level, tightly packed
+    std::vector<ImageLevel> MipChainLevelsRGBA8(uint32_t w, uint32_t h, uint32_t mipLevels);
+    VkDeviceSize MipChainSizeRGBA8(const std::vector<ImageLevel>& levels);
+
+    ///cpu fallback for formats that can't be blitted with a linear filter, out (MipChainSizeRGBA8 bytes)
+    ///is only written, never read back, so it can be write combined staging memory
+    void BuildMipChainRGBA8(const uint8_t* src, const std::vector<ImageLevel>& levels, uint8_t* out);
+}
+
+#endif
@@ -0,0 +1,26 @@
+#include "VlkApp.h"
+#include "errLog.h"
+
+using namespace VulkanTut;
+
+void VlkApp::CreateOffscreenTargets(uint32_t w, uint32_t h)
+{
+    ///stand-ins for swapchain images, one per frame in flight so no acquire is needed
+    _swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    _swapChainExtent = {w, h};
+
+    _swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    _offscreenImgMemory.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for(size_t i{0}; i<MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        std::tie(_swapChainImages[i], _offscreenImgMemory[i]) = CreateImage(w, h, _swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+                                                                            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if(_swapChainImages[i] == VK_NULL_HANDLE)
+        {
+            LOG_ARGS("offscreen target {} creation failed", i);
+        }
+    }
+}
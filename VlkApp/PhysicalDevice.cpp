@@ -39,8 +39,8 @@ bool VlkApp::IsDeviceSuitable(VkPhysicalDevice device, const std::vector<const c
     auto indices = FindQueueFamilies(device);
     auto extSupported = CheckDeviceExtensionsSupport(device, deviceExtensions);
 
-    bool isSwapChainSuitable{false};
-    if(extSupported)
+    bool isSwapChainSuitable{_headless};
+    if(extSupported && !_headless)
     {
         auto swapChainSupport = QuerySwapChainSupport(device);
         isSwapChainSuitable = !swapChainSupport.formats.empty()             &&
@@ -55,9 +55,31 @@ bool VlkApp::IsDeviceSuitable(VkPhysicalDevice device, const std::vector<const c
            indices.presentFamily.has_value()  &&
            indices.transferFamily.has_value() &&
            features.samplerAnisotropy         &&
+           CheckTimelineSupport(device)       &&
            extSupported && isSwapChainSuitable;
 }
 
+bool VlkApp::CheckTimelineSupport(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    ///the frame loop syncs on a timeline semaphore only, features2 is a core 1.1 entry point
+    if(properties.apiVersion < VK_API_VERSION_1_1 ||
+       !CheckDeviceExtensionsSupport(device, {VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME}))
+        return false;
+
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &timelineFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return timelineFeatures.timelineSemaphore;
+}
+
 bool VlkApp::CheckDeviceExtensionsSupport(VkPhysicalDevice device, const std::vector<const char *>& deviceExtensions)
 {
     uint32_t extCount{0};
@@ -89,7 +111,8 @@ VlkApp::QueueFamilyIndices VlkApp::FindQueueFamilies(VkPhysicalDevice device)
     for(const auto& queueFamily : queueFamilies)
     {
         VkBool32 presentationSupport{false};
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentationSupport);
+        if(!_headless)
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentationSupport);
         if(presentationSupport)
         {
             indices.presentFamily = i;
@@ -110,6 +133,9 @@ VlkApp::QueueFamilyIndices VlkApp::FindQueueFamilies(VkPhysicalDevice device)
         ++i;
     }
 
+    if(_headless && indices.graphicsFamily.has_value())
+        indices.presentFamily = indices.graphicsFamily.value();
+
     if(!indices.transferFamily.has_value())
         indices.transferFamily = indices.graphicsFamily.value();
 
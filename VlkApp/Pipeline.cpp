@@ -2,53 +2,140 @@
 #include "errLog.h"
 #include "quad.h"
 
+#include <chrono>
+
+static constexpr std::array<VkDynamicState, 2> DynamicStates
+{
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR
+};
+
 using namespace VulkanTut;
 
-void VlkApp::CreateProgram(std::string_view vSh, std::string_view fSh)
+bool VlkApp::CreateProgram(std::string_view vSh, std::string_view fSh)
 {
-    _shader = {_device, vSh, fSh};
+    _program = _shaderLibrary.LoadProgram({{VK_SHADER_STAGE_VERTEX_BIT, vSh}, {VK_SHADER_STAGE_FRAGMENT_BIT, fSh}});
+    if(!_program.valid())
+    {
+        LOG_ARGS("graphics program {} + {} is incomplete", vSh, fSh);
+        return false;
+    }
+
+    return true;
 }
 
 void VlkApp::CreateDescriptorSetLayout()
 {
-    VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
-    layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-
     std::array<VkDescriptorSetLayoutBinding, 2> layoutBindings = {Quad::GetUBODescriptorLayoutBinding(),
                                                                   GetSamplerLayoutBinding()             };
-    layoutCreateInfo.pBindings = layoutBindings.data();
-    layoutCreateInfo.bindingCount = layoutBindings.size();
 
-    if(vkCreateDescriptorSetLayout(_device, &layoutCreateInfo, nullptr, &_descriptorSetLayout) != VK_SUCCESS)
+    _descriptorSetLayout = _descriptorCache.Layout(layoutBindings);
+
+    if(_bindless)
+        CreateBindlessLayout();
+}
+
+void VlkApp::CreatePipeline()
+{
+    ///the layout only depends on the descriptor set layout, it survives pipeline rebuilds
+    if(_pipelineLayout == VK_NULL_HANDLE)
     {
-        LOG("descriptor creation failed");
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        std::array<VkDescriptorSetLayout, 2> setLayouts{_descriptorSetLayout, _bindlessSetLayout};
+        pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutCreateInfo.setLayoutCount = _bindless ? 2 : 1;
+
+        ///per draw model matrix and texture base, no buffer write or descriptor needed to change them
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(drawConstants);
+
+        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+
+        if(vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
+        {
+            LOG("pipeline layout creation failed");
+        }
     }
+
+    _pipeline = GetPipelineVariant(_material);
 }
 
-void VlkApp::CreatePipeline()
+VkPipeline VlkApp::GetPipelineVariant(const PipelineState& state)
+{
+    if(auto it = _pipelineVariants.find(state); it != _pipelineVariants.end())
+        return it->second;
+
+    if(!state.Valid())
+    {
+        LOG("pipeline state conflicts with depth writes, variant not built");
+        return VK_NULL_HANDLE;
+    }
+
+    VkPipelineCreationFeedbackEXT feedback{};
+    auto beginTime = std::chrono::steady_clock::now();
+
+    auto pipeline = BuildGraphicsPipeline(_program, _renderPass, state, _pipelineFeedback ? &feedback : nullptr);
+
+    _pipelineCache.Record(_pipelineFeedback ? &feedback : nullptr,
+                          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count());
+
+    if(pipeline != VK_NULL_HANDLE)
+        _pipelineVariants.emplace(state, pipeline);
+
+    return pipeline;
+}
+
+void VlkApp::RetirePipelineVariants(uint64_t safeAfterFrames)
 {
-    VkPipelineShaderStageCreateInfo vShCreateInfo{};
-    vShCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vShCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vShCreateInfo.module = _shader.vertModule();
-    vShCreateInfo.pName = "main";
+    _deletionQueue.Push(safeAfterFrames, [this, variants = std::move(_pipelineVariants)]()
+    {
+        for(const auto&[state, pipeline] : variants)
+            vkDestroyPipeline(_device, pipeline, nullptr);
+    });
 
-    VkPipelineShaderStageCreateInfo fShCreateInfo{};
-    fShCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fShCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fShCreateInfo.module = _shader.fragModule();
-    fShCreateInfo.pName = "main";
+    _pipelineVariants.clear();
+}
 
-    VkPipelineShaderStageCreateInfo shaderStages[] { vShCreateInfo, fShCreateInfo };
+///reads only state fixed after setup (device, layout, cache), the hot reload thread calls it while frames are recorded
+VkPipeline VlkApp::BuildGraphicsPipeline(const ShaderProgram& program, VkRenderPass renderPass, const PipelineState& state,
+                                         VkPipelineCreationFeedbackEXT* feedback) const
+{
+    ///feature branches become constants, the driver drops the dead ones
+    const SpecializationData specData{state.features, state.opacity};
+
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = SpecializationMap.size();
+    specInfo.pMapEntries = SpecializationMap.data();
+    specInfo.dataSize = sizeof(specData);
+    specInfo.pData = &specData;
+
+    auto shaderStages = program.StageInfos();
+    for(auto& stage : shaderStages)
+        stage.pSpecializationInfo = &specInfo;
+
+    ///binding 0 per vertex quad data, binding 1 per instance transforms
+    std::array<VkVertexInputBindingDescription, 2> bindingDescs
+    {
+        Quad::GetVertexBindingDescription(),
+        Quad::GetInstanceBindingDescription()
+    };
 
-    auto bindingDesc = Quad::GetVertexBindingDescription();
-    auto attribDescs = Quad::GetVertexAttribDescriptions();
+    auto vertexAttribDescs = Quad::GetVertexAttribDescriptions();
+    auto instanceAttribDescs = Quad::GetInstanceAttribDescriptions();
+
+    std::array<VkVertexInputAttributeDescription, vertexAttribDescs.size() + instanceAttribDescs.size()> attribDescs{};
+    std::copy(vertexAttribDescs.begin(), vertexAttribDescs.end(), attribDescs.begin());
+    std::copy(instanceAttribDescs.begin(), instanceAttribDescs.end(), attribDescs.begin() + vertexAttribDescs.size());
 
     VkPipelineVertexInputStateCreateInfo vInputInfo{};
     vInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vInputInfo.vertexBindingDescriptionCount = 1;
-    vInputInfo.pVertexBindingDescriptions = &bindingDesc;
-    vInputInfo.vertexAttributeDescriptionCount = 3;
+    vInputInfo.vertexBindingDescriptionCount = bindingDescs.size();
+    vInputInfo.pVertexBindingDescriptions = bindingDescs.data();
+    vInputInfo.vertexAttributeDescriptionCount = attribDescs.size();
     vInputInfo.pVertexAttributeDescriptions = attribDescs.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAsmCreateInfo{};
@@ -56,23 +143,12 @@ void VlkApp::CreatePipeline()
     inputAsmCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAsmCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-    VkViewport viewport{};
-    viewport.x = .0f;
-    viewport.y = .0f;
-    viewport.width = static_cast<float>(_swapChainExtent.width);
-    viewport.height = static_cast<float>(_swapChainExtent.height);
-    viewport.minDepth = .0f;
-    viewport.maxDepth = 1.f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = _swapChainExtent;
-
+    ///viewport and scissor are dynamic (set at record time), the pipeline doesn't depend on the swapchain extent
     VkPipelineViewportStateCreateInfo vpCreateInfo{};
     vpCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    vpCreateInfo.pViewports = &viewport;
+    vpCreateInfo.pViewports = nullptr;
     vpCreateInfo.viewportCount = 1;
-    vpCreateInfo.pScissors = &scissor;
+    vpCreateInfo.pScissors = nullptr;
     vpCreateInfo.scissorCount = 1;
 
     VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo{};
@@ -81,7 +157,7 @@ void VlkApp::CreatePipeline()
     rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE;
     rasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizerCreateInfo.lineWidth = 1.f;
-    rasterizerCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizerCreateInfo.cullMode = state.cullMode;
     rasterizerCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
     rasterizerCreateInfo.depthBiasEnable = VK_FALSE;
     rasterizerCreateInfo.depthBiasConstantFactor = .0f;
@@ -99,8 +175,8 @@ void VlkApp::CreatePipeline()
 
     VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
     depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-    depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+    depthStencilStateCreateInfo.depthTestEnable = state.depthTest;
+    depthStencilStateCreateInfo.depthWriteEnable = state.depthWrite;
     depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
     depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
     depthStencilStateCreateInfo.minDepthBounds = .0f;
@@ -114,9 +190,9 @@ void VlkApp::CreatePipeline()
                                      VK_COLOR_COMPONENT_G_BIT |
                                      VK_COLOR_COMPONENT_B_BIT |
                                      VK_COLOR_COMPONENT_A_BIT ;
-    blendAttachment.blendEnable = VK_FALSE;
-    blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    blendAttachment.blendEnable = state.blend;
+    blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
     blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
     blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
@@ -135,25 +211,13 @@ void VlkApp::CreatePipeline()
 
     VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
     dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicStateCreateInfo.dynamicStateCount = 0;
-    dynamicStateCreateInfo.pDynamicStates = nullptr;
-
-    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutCreateInfo.pSetLayouts = &_descriptorSetLayout;
-    pipelineLayoutCreateInfo.setLayoutCount = 1;
-    pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
-    pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-
-    if(vkCreatePipelineLayout(_device, &pipelineLayoutCreateInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
-    {
-        LOG("pipeline layout creation failed");
-    }
+    dynamicStateCreateInfo.dynamicStateCount = DynamicStates.size();
+    dynamicStateCreateInfo.pDynamicStates = DynamicStates.data();
 
     VkGraphicsPipelineCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    createInfo.stageCount = 2;
-    createInfo.pStages = shaderStages;
+    createInfo.stageCount = shaderStages.size();
+    createInfo.pStages = shaderStages.data();
     createInfo.pVertexInputState = &vInputInfo;
     createInfo.pInputAssemblyState = &inputAsmCreateInfo;
     createInfo.pViewportState = &vpCreateInfo;
@@ -163,16 +227,25 @@ void VlkApp::CreatePipeline()
     createInfo.pColorBlendState = &blendStateCreateInfo;
     createInfo.pDynamicState = &dynamicStateCreateInfo;
     createInfo.layout = _pipelineLayout;
-    createInfo.renderPass = _renderPass;
+    createInfo.renderPass = renderPass;
     createInfo.subpass = 0;
     createInfo.basePipelineHandle = VK_NULL_HANDLE;
     createInfo.basePipelineIndex = -1;
     createInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 
-    if(vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &_pipeline) != VK_SUCCESS)
+    VkPipelineCreationFeedbackCreateInfoEXT feedbackCreateInfo{};
+    feedbackCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+    feedbackCreateInfo.pPipelineCreationFeedback = feedback;
+    if(feedback != nullptr)
+        createInfo.pNext = &feedbackCreateInfo;
+
+    VkPipeline pipeline{VK_NULL_HANDLE};
+    if(vkCreateGraphicsPipelines(_device, _pipelineCache.handle(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         LOG("creation of graphics pipeline failed");
     }
+
+    return pipeline;
 }
 
 void VlkApp::CreateRenderPass()
@@ -199,7 +272,7 @@ void VlkApp::CreateRenderPass()
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = _headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -0,0 +1,192 @@
+#include "PipelineCache.h"
+#include "Hash.h"
+#include "errLog.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace VulkanTut;
+
+namespace
+{
+    constexpr uint32_t CacheFileMagic{0x43504b56}; ///"VKPC"
+    constexpr uint32_t CacheFileVersion{1};
+
+    struct CacheFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t uuid[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t checksum;
+    };
+
+    ///layout of the header every driver puts in front of vkGetPipelineCacheData (VkPipelineCacheHeaderVersionOne)
+    struct VkCacheBlobHeader
+    {
+        uint32_t headerSize;
+        uint32_t headerVersion;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint8_t uuid[VK_UUID_SIZE];
+    };
+
+    ///returns the driver blob or an empty vector if the file is missing, corrupt or from another device/driver
+    std::vector<char> LoadBlob(const std::string& path, const VkPhysicalDeviceProperties& props)
+    {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if(!stream)
+            return {};
+
+        auto fileSize = static_cast<size_t>(stream.tellg());
+        if(fileSize < sizeof(CacheFileHeader))
+            return {};
+
+        CacheFileHeader header{};
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if(header.magic != CacheFileMagic || header.version != CacheFileVersion ||
+           header.vendorID != props.vendorID || header.deviceID != props.deviceID ||
+           header.driverVersion != props.driverVersion ||
+           std::memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) != 0 ||
+           header.dataSize != fileSize - sizeof(CacheFileHeader))
+            return {};
+
+        std::vector<char> blob(header.dataSize);
+        stream.read(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if(!stream || Fnv1a(blob.data(), blob.size()) != header.checksum)
+            return {};
+
+        ///the driver validates this too, but some implementations have been known to crash on stale data
+        VkCacheBlobHeader blobHeader{};
+        if(blob.size() < sizeof(blobHeader))
+            return {};
+        std::memcpy(&blobHeader, blob.data(), sizeof(blobHeader));
+
+        if(blobHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+           blobHeader.vendorID != props.vendorID || blobHeader.deviceID != props.deviceID ||
+           std::memcmp(blobHeader.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+            return {};
+
+        return blob;
+    }
+}
+
+void PipelineCache::Create(VkDevice device, VkPhysicalDevice pDevice, std::string_view path)
+{
+    _device = device;
+    _path = path;
+    _stats = {};
+    vkGetPhysicalDeviceProperties(pDevice, &_properties);
+
+    auto blob = LoadBlob(_path, _properties);
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = blob.size();
+    createInfo.pInitialData = blob.empty() ? nullptr : blob.data();
+
+    if(vkCreatePipelineCache(_device, &createInfo, nullptr, &_cache) != VK_SUCCESS)
+    {
+        ///retry empty, a rejected blob shouldn't cost us the cache altogether
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        blob.clear();
+
+        if(vkCreatePipelineCache(_device, &createInfo, nullptr, &_cache) != VK_SUCCESS)
+        {
+            LOG("pipeline cache creation failed");
+            _cache = VK_NULL_HANDLE;
+        }
+    }
+
+    _stats.loadedBytes = blob.size();
+}
+
+void PipelineCache::Delete()
+{
+    if(_cache != VK_NULL_HANDLE)
+        vkDestroyPipelineCache(_device, _cache, nullptr);
+
+    _cache = VK_NULL_HANDLE;
+}
+
+bool PipelineCache::Save() const
+{
+    if(_cache == VK_NULL_HANDLE || _path.empty())
+        return false;
+
+    size_t dataSize{0};
+    if(vkGetPipelineCacheData(_device, _cache, &dataSize, nullptr) != VK_SUCCESS)
+    {
+        LOG("pipeline cache size query failed");
+        return false;
+    }
+
+    std::vector<char> blob(dataSize);
+    if(vkGetPipelineCacheData(_device, _cache, &dataSize, blob.data()) != VK_SUCCESS)
+    {
+        LOG("pipeline cache data retrieval failed");
+        return false;
+    }
+    blob.resize(dataSize);
+
+    CacheFileHeader header{};
+    header.magic = CacheFileMagic;
+    header.version = CacheFileVersion;
+    header.vendorID = _properties.vendorID;
+    header.deviceID = _properties.deviceID;
+    header.driverVersion = _properties.driverVersion;
+    std::memcpy(header.uuid, _properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = blob.size();
+    header.checksum = Fnv1a(blob.data(), blob.size());
+
+    auto tmpPath = _path + ".tmp";
+    {
+        std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        stream.flush();
+
+        if(!stream)
+        {
+            LOG_ARGS("could not write {}", tmpPath);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, _path, ec);
+    if(ec)
+    {
+        LOG_ARGS("could not replace {}: {}", _path, ec.message());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+void PipelineCache::Record(const VkPipelineCreationFeedbackEXT* feedback, double createMs)
+{
+    _stats.createMs += createMs;
+
+    if(feedback == nullptr || !(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT))
+        ++_stats.unknown;
+    else if(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT)
+        ++_stats.hits;
+    else
+        ++_stats.misses;
+}
+
+void PipelineCache::PrintStats() const
+{
+    fmt::print("| pipeline cache | loaded {} B | {} hits | {} cold | {} unknown | {:.3f} ms creating |\n",
+               _stats.loadedBytes, _stats.hits, _stats.misses, _stats.unknown, _stats.createMs);
+}
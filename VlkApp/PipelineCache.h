@@ -0,0 +1,50 @@
+#ifndef VULKANTUT2_PIPELINECACHE_H
+#define VULKANTUT2_PIPELINECACHE_H
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include <string_view>
+
+namespace VulkanTut
+{
+    ///VkPipelineCache backed by a file, the blob is prefixed with our own header
+    ///(device/vendor id, driver version, cache uuid, checksum) and discarded on any mismatch
+    class PipelineCache
+    {
+        public:
+            struct Stats
+            {
+                uint32_t hits{0};        ///feedback reported APPLICATION_PIPELINE_CACHE_HIT
+                uint32_t misses{0};      ///feedback reported a cold compile
+                uint32_t unknown{0};     ///created without creation feedback support
+                double createMs{.0};     ///cpu time spent in pipeline creation
+                size_t loadedBytes{0};   ///0 when the cache started empty
+            };
+
+            PipelineCache() = default;
+
+            void Create(VkDevice, VkPhysicalDevice, std::string_view path);
+            void Delete();
+
+            ///writes to <path>.tmp and renames it over <path>, a crash never leaves a torn cache behind
+            bool Save() const;
+
+            ///feedback may be nullptr when VK_EXT_pipeline_creation_feedback isn't enabled
+            void Record(const VkPipelineCreationFeedbackEXT* feedback, double createMs);
+
+            void PrintStats() const;
+
+            auto handle() const { return _cache; }
+            const auto& stats() const { return _stats; }
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            VkPipelineCache _cache{VK_NULL_HANDLE};
+            VkPhysicalDeviceProperties _properties{};
+            std::string _path;
+
+            Stats _stats{};
+    };
+}
+
+#endif
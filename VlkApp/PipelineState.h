@@ -0,0 +1,83 @@
+#ifndef VULKANTUT2_PIPELINESTATE_H
+#define VULKANTUT2_PIPELINESTATE_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "Hash.h"
+
+namespace VulkanTut
+{
+    ///material feature bits, handed to the fragment shader as specialization constant 0 (FEATURES),
+    ///branches on them are folded away when the driver compiles the pipeline
+    namespace MaterialFeature
+    {
+        static constexpr uint32_t None{0};
+        static constexpr uint32_t Textured{1u << 0};    ///multiply by the texture sample
+        static constexpr uint32_t VertexColor{1u << 1}; ///multiply by the interpolated vertex color
+    }
+
+    ///everything a graphics pipeline variant differs in, all 32 bit so the state hashes without padding
+    struct PipelineState
+    {
+        VkCullModeFlags cullMode{VK_CULL_MODE_BACK_BIT};
+        VkBool32 depthTest{VK_TRUE};
+        VkBool32 depthWrite{VK_TRUE};
+        VkBool32 blend{VK_FALSE}; ///src alpha over
+        uint32_t features{MaterialFeature::Textured | MaterialFeature::VertexColor};
+        float opacity{1.f}; ///scales the fragment alpha, specialization constant 1 (OPACITY)
+
+        constexpr uint64_t Hash() const
+        {
+            uint64_t hash{Fnv1aBasis};
+            for(uint32_t word : {cullMode, depthTest, depthWrite, blend, features, std::bit_cast<uint32_t>(opacity)})
+                hash = Fnv1aWord(word, hash);
+            return hash;
+        }
+
+        ///depth writes behind a blended surface hide what it should let through,
+        ///and an alpha below 1 only shows through when it is blended
+        constexpr bool Valid() const
+        {
+            return !(blend && depthWrite) && !(depthWrite && !depthTest) && (blend || opacity >= 1.f);
+        }
+
+        constexpr bool operator==(const PipelineState&) const = default;
+    };
+
+    struct PipelineStateHash
+    {
+        size_t operator()(const PipelineState& state) const { return static_cast<size_t>(state.Hash()); }
+    };
+
+    ///layout of the specialization data, one entry per constant_id
+    struct SpecializationData
+    {
+        uint32_t features;
+        float opacity;
+    };
+
+    static constexpr std::array<VkSpecializationMapEntry, 2> SpecializationMap
+    {{
+        {0, offsetof(SpecializationData, features), sizeof(uint32_t)},
+        {1, offsetof(SpecializationData, opacity), sizeof(float)}
+    }};
+
+    ///material presets, checked and hashed at compile time
+    namespace Materials
+    {
+        static constexpr PipelineState Textured{};
+        static constexpr PipelineState Untextured{VK_CULL_MODE_BACK_BIT, VK_TRUE, VK_TRUE, VK_FALSE, MaterialFeature::VertexColor};
+        static constexpr PipelineState TextureOnly{VK_CULL_MODE_BACK_BIT, VK_TRUE, VK_TRUE, VK_FALSE, MaterialFeature::Textured};
+        static constexpr PipelineState Transparent{VK_CULL_MODE_NONE, VK_TRUE, VK_FALSE, VK_TRUE,
+                                                   MaterialFeature::Textured | MaterialFeature::VertexColor, .5f};
+
+        static_assert(Textured.Valid() && Untextured.Valid() && TextureOnly.Valid() && Transparent.Valid());
+        static_assert(Textured.Hash() != Untextured.Hash() && Textured.Hash() != Transparent.Hash());
+    }
+}
+
+#endif
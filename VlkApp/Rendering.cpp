@@ -1,7 +1,12 @@
 #include "VlkApp.h"
 #include "errLog.h"
+
+#include <chrono>
+
 using namespace VulkanTut;
 
+using FrameClock = std::chrono::steady_clock;
+
 void VlkApp::CreateSemaphores()
 {
     _imgAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
@@ -20,64 +25,198 @@ void VlkApp::CreateSemaphores()
     }
 }
 
-void VlkApp::CreateFences()
+void VlkApp::CreateFrameTimeline()
 {
-    _inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    _swapchainImgInFlightFences.resize(_swapChainImages.size(), VK_NULL_HANDLE);
+    ///counts retired frames, _frameNumber frames were already submitted and retired if any
+    if(!_frameTimeline.Create(_device, _frameNumber))
+    {
+        LOG("frame timeline creation failed");
+    }
+}
 
-    VkFenceCreateInfo fenceCreateInfo{};
-    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+void VlkApp::CreateTimestampQueries()
+{
+    auto indices = FindQueueFamilies(_physicalDevice);
 
-    for(size_t i{0}; i<MAX_FRAMES_IN_FLIGHT; ++i)
+    uint32_t queueFamiliesCount{0};
+    vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamiliesCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamiliesCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamiliesCount, queueFamilies.data());
+
+    const auto validBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+    if(!validBits)
     {
-        if(vkCreateFence(_device, &fenceCreateInfo, nullptr, &_inFlightFences[i]) != VK_SUCCESS)
-        {
-            LOG_ARGS("{} fence creation failed", i);
-        }
+        LOG("graphics queue has no timestamp support, gpu timing disabled");
+        return;
     }
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+
+    _timestampPeriodMs = static_cast<double>(properties.limits.timestampPeriod) / 1e6;
+    _timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo{};
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = MAX_FRAMES_IN_FLIGHT * 2;
+
+    if(vkCreateQueryPool(_device, &queryPoolCreateInfo, nullptr, &_timestampPool) != VK_SUCCESS)
+    {
+        LOG("timestamp query pool creation failed");
+        _timestampPool = VK_NULL_HANDLE;
+    }
+}
+
+void VlkApp::SetLatencyProfile(LatencyProfile profile)
+{
+    if(_swapChainImages.empty())
+    {
+        _latencyProfile = profile;
+        _framesInFlight = GetLatencyConfig(profile).framesInFlight;
+        return;
+    }
+
+    _pendingProfile = profile;
+}
+
+void VlkApp::ApplyLatencyProfile(LatencyProfile profile)
+{
+    ///with every submitted frame retired the slot count and the frame -> slot mapping can change freely
+    _frameTimeline.Wait(_frameNumber);
+    _deletionQueue.Flush(_frameNumber);
+
+    _latencyProfile = profile;
+    _framesInFlight = GetLatencyConfig(profile).framesInFlight;
+    _currentFrame = 0;
+    _timestampsPending.fill(false);
+    _inputPending.fill(false);
+
+    ///sets of slots that sat idle may be outdated, retired textures only wait for the slots that cycle from now on
+    for(auto& slot : _textures)
+        for(uint32_t frame{0}; frame<MAX_FRAMES_IN_FLIGHT; ++frame)
+            slot.stale[frame] = frame < _framesInFlight;
+
+    ///present mode and image count are fixed at swapchain creation
+    if(!_headless)
+        RecreateSwapchain();
 }
 
 void VlkApp::DrawFrame()
 {
-    static size_t currentFrame{0};
+    if(_pendingProfile.has_value())
+    {
+        ApplyLatencyProfile(_pendingProfile.value());
+        _pendingProfile.reset();
+    }
 
-    vkWaitForFences(_device, 1, &_inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    const auto currentFrame = _currentFrame;
+
+    _frameStats.BeginFrame();
+    const auto frameBegin = FrameClock::now();
+    auto lapBegin = frameBegin;
+    auto lap = [&](FrameStage stage){
+        auto now = FrameClock::now();
+        _frameStats.Set(stage, std::chrono::duration<double, std::milli>(now - lapBegin).count());
+        lapBegin = now;
+    };
+
+    ///the slot was last used by frame _frameNumber - _framesInFlight, once that retired its command buffer,
+    ///uniform segment, transient descriptor sets and timestamps are free again
+    if(_frameNumber >= _framesInFlight)
+        _frameTimeline.Wait(_frameNumber + 1 - _framesInFlight);
+    _frameDescriptors[currentFrame].Reset();
+
+    ///the timestamps of the previous use of this slot are available
+    if(_timestampsPending[currentFrame])
+    {
+        std::array<uint64_t, 2> ticks{};
+        if(vkGetQueryPoolResults(_device, _timestampPool, currentFrame * 2, 2, sizeof(ticks), ticks.data(),
+                                 sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+            _frameStats.Set(FrameStage::Gpu, static_cast<double>((ticks[1] - ticks[0]) & _timestampMask) * _timestampPeriodMs);
 
-    uint32_t imageIndex;
-    auto result = vkAcquireNextImageKHR(_device, _swapChain, UINT64_MAX, _imgAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        _timestampsPending[currentFrame] = false;
+    }
 
-    if(result == VK_ERROR_OUT_OF_DATE_KHR)
+    ///upper bound of input to present, the frame may have retired before this wait started
+    if(_inputPending[currentFrame])
     {
-        RecreateSwapchain();
-        return;
+        _frameStats.Set(FrameStage::Latency, std::chrono::duration<double, std::milli>(FrameClock::now() - _inputTimes[currentFrame]).count());
+        _inputPending[currentFrame] = false;
+    }
+
+    ///the counter is the number of retired frames, newer frames than the waited one may be done too
+    _deletionQueue.Flush(_frameTimeline.Query());
+
+    UpdateTextureDescriptors(currentFrame);
+    ///frame boundary, reloaded pipelines are used from this frame on
+    _shaderReloader.Poll();
+
+    lap(FrameStage::FrameWait);
+
+    ///offscreen targets are owned per frame in flight, nothing to acquire
+    uint32_t imageIndex{static_cast<uint32_t>(currentFrame)};
+    if(!_headless)
+    {
+        auto result = vkAcquireNextImageKHR(_device, _swapChain, UINT64_MAX, _imgAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+        if(result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            RecreateSwapchain();
+            return;
+        }
     }
 
-    if(_swapchainImgInFlightFences[imageIndex] != VK_NULL_HANDLE)
-        vkWaitForFences(_device, 1, &_swapchainImgInFlightFences[imageIndex], VK_TRUE, UINT64_MAX);
+    lap(FrameStage::Acquire);
 
-    _swapchainImgInFlightFences[imageIndex] = _inFlightFences[currentFrame];
+    ///no per image wait, an image is only acquired again after its present, which waited for the frame rendering it
+    _inputTimes[currentFrame] = FrameClock::now();
+    _inputPending[currentFrame] = true;
+    auto uboOffset = Update(currentFrame);
+    lap(FrameStage::Update);
 
-    Update(imageIndex);
+    RecordCommandBuffer(currentFrame, imageIndex, uboOffset);
+    lap(FrameStage::Record);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkPipelineStageFlags waitStage{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = _headless ? 0 : 1;
     submitInfo.pWaitSemaphores = &_imgAvailableSemaphores[currentFrame];
     submitInfo.pWaitDstStageMask = &waitStage;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &_cmdBuffers[imageIndex];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &_renderFinishedSemaphores[currentFrame];
+    submitInfo.pCommandBuffers = &_cmdBuffers[currentFrame];
+
+    ///binary semaphores ignore their value
+    std::array<VkSemaphore, 2> signalSemaphores{_frameTimeline.semaphore(), _renderFinishedSemaphores[currentFrame]};
+    std::array<uint64_t, 2> signalValues{_frameNumber + 1, 0};
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.signalSemaphoreValueCount = _headless ? 1 : 2;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.signalSemaphoreCount = _headless ? 1 : 2;
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
 
-    vkResetFences(_device, 1, &_inFlightFences[currentFrame]);
-    if(vkQueueSubmit(_graphicsQueue, 1, &submitInfo, _inFlightFences[currentFrame]) != VK_SUCCESS)
+    if(vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
     {
         LOG("submission of command failed");
     }
 
+    lap(FrameStage::Submit);
+
+    if(_headless)
+    {
+        _frameStats.Set(FrameStage::Total, std::chrono::duration<double, std::milli>(FrameClock::now() - frameBegin).count());
+        _frameStats.EndFrame();
+
+        AdvanceFrame();
+        return;
+    }
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -87,7 +226,8 @@ void VlkApp::DrawFrame()
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr;
 
-    result = vkQueuePresentKHR(_presentationQueue, &presentInfo);
+    auto result = vkQueuePresentKHR(_presentationQueue, &presentInfo);
+    lap(FrameStage::Present);
 
     if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _recreationInfo.flag)
     {
@@ -95,5 +235,14 @@ void VlkApp::DrawFrame()
         RecreateSwapchain();
     }
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    _frameStats.Set(FrameStage::Total, std::chrono::duration<double, std::milli>(FrameClock::now() - frameBegin).count());
+    _frameStats.EndFrame();
+
+    AdvanceFrame();
+}
+
+void VlkApp::AdvanceFrame()
+{
+    _currentFrame = (_currentFrame + 1) % _framesInFlight;
+    ++_frameNumber;
 }
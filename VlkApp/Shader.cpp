@@ -1,55 +1,201 @@
 #include "Shader.h"
+#include "Hash.h"
+#include "MappedFile.h"
 #include "errLog.h"
-#include <fstream>
 
-static std::vector<char> ParseShader(std::string_view path)
+#include <cstdint>
+#include <cstring>
+
+using namespace VulkanTut;
+
+namespace
 {
-    std::ifstream stream(path.data(), std::ios::binary|std::ios::ate);
+    constexpr uint32_t SpirvMagic{0x07230203};
+    constexpr size_t SpirvHeaderSize{5 * sizeof(uint32_t)};
+
+    ///whole words, at least a header, native endian magic, pCode must be 4 byte aligned
+    bool ValidateSpirv(std::string_view path, const MappedFile& file)
+    {
+        if(!file.valid())
+        {
+            LOG_ARGS("could not map shader {}", path);
+            return false;
+        }
+
+        if(file.size() < SpirvHeaderSize || file.size() % sizeof(uint32_t) != 0)
+        {
+            LOG_ARGS("{} is not SPIR-V, size {} is not a whole number of words", path, file.size());
+            return false;
+        }
+
+        if(reinterpret_cast<uintptr_t>(file.data()) % alignof(uint32_t) != 0)
+        {
+            LOG_ARGS("{} is not word aligned in memory", path);
+            return false;
+        }
+
+        uint32_t magic{0};
+        std::memcpy(&magic, file.data(), sizeof(magic));
+        if(magic != SpirvMagic)
+        {
+            LOG_ARGS("{} has bad SPIR-V magic {:#010x}", path, magic);
+            return false;
+        }
 
-    auto size = static_cast<size_t>(stream.tellg());
-    std::vector<char> code(size);
+        return true;
+    }
+}
 
-    stream.seekg(0);
-    stream.read(code.data(), size);
+std::vector<VkPipelineShaderStageCreateInfo> ShaderProgram::StageInfos() const
+{
+    std::vector<VkPipelineShaderStageCreateInfo> infos(_stages.size());
+    for(size_t i{0}; i<_stages.size(); ++i)
+    {
+        infos[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        infos[i].stage = _stages[i].stage;
+        infos[i].module = _stages[i].module;
+        infos[i].pName = "main";
+    }
+
+    return infos;
+}
+
+VkShaderModule ShaderProgram::module(VkShaderStageFlagBits stage) const
+{
+    for(const auto& s : _stages)
+        if(s.stage == stage)
+            return s.module;
+
+    return VK_NULL_HANDLE;
+}
+
+bool ShaderProgram::uses(std::string_view path) const
+{
+    for(const auto& s : _stages)
+        if(s.path == path)
+            return true;
+
+    return false;
+}
+
+void ShaderLibrary::Create(VkDevice device)
+{
+    _device = device;
+    _stats = {};
+}
+
+void ShaderLibrary::Delete()
+{
+    std::lock_guard lock(_mutex);
 
-    stream.close();
+    for(auto module : _modules)
+        vkDestroyShaderModule(_device, module, nullptr);
 
-    return code;
+    _modules.clear();
+    _byContent.clear();
+    _byPath.clear();
 }
 
-VulkanTut::ShaderVF::ShaderVF(VkDevice device, std::string_view vSh, std::string_view fSh)
-    : _device(device)
+VkShaderModule ShaderLibrary::Load(std::string_view path)
 {
-    const auto vCode = ParseShader(vSh);
-    const auto fCode = ParseShader(fSh);
+    std::lock_guard lock(_mutex);
+    return LoadLocked(path);
+}
 
-    _vshModule = CreateModule(vCode);
-    _fshModule = CreateModule(fCode);
+VkShaderModule ShaderLibrary::Reload(std::string_view path)
+{
+    std::lock_guard lock(_mutex);
+    _byPath.erase(std::string(path));
+    return LoadLocked(path);
 }
 
-VkShaderModule VulkanTut::ShaderVF::CreateModule(const std::vector<char>& code)
+VkShaderModule ShaderLibrary::LoadLocked(std::string_view path)
 {
+    std::string key(path);
+    if(auto it = _byPath.find(key); it != _byPath.end())
+    {
+        ++_stats.pathHits;
+        return it->second;
+    }
+
+    MappedFile file(path);
+    if(!ValidateSpirv(path, file))
+    {
+        ++_stats.rejected;
+        return VK_NULL_HANDLE;
+    }
+
+    ///same bytes under another path (copies, symlinks) share one module, size guards against hash collisions
+    const auto hash = Fnv1a(file.data(), file.size());
+    if(auto it = _byContent.find(hash); it != _byContent.end() && it->second.size == file.size())
+    {
+        ++_stats.contentHits;
+        _byPath.emplace(std::move(key), it->second.module);
+        return it->second.module;
+    }
+
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.codeSize = file.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(file.data());
 
-    VkShaderModule module;
+    VkShaderModule module{VK_NULL_HANDLE};
     if(vkCreateShaderModule(_device, &createInfo, nullptr, &module) != VK_SUCCESS)
     {
-        LOG_ARGS("creation of shader module failed, code size {}", code.size());
+        LOG_ARGS("creation of shader module {} failed, code size {}", path, file.size());
+        ++_stats.rejected;
         return VK_NULL_HANDLE;
     }
 
+    ++_stats.modules;
+    _stats.bytes += file.size();
+
+    _modules.push_back(module);
+    _byContent.emplace(hash, Module{module, file.size()});
+    _byPath.emplace(std::move(key), module);
+
     return module;
 }
 
-void VulkanTut::ShaderVF::Delete() const
+ShaderProgram ShaderLibrary::LoadProgram(std::initializer_list<std::pair<VkShaderStageFlagBits, std::string_view>> stages)
 {
-    vkDestroyShaderModule(_device, _vshModule, nullptr);
-    vkDestroyShaderModule(_device, _fshModule, nullptr);
+    ShaderProgram program{};
+
+    for(const auto&[stage, path] : stages)
+    {
+        auto module = Load(path);
+        if(module == VK_NULL_HANDLE)
+            program._valid = false;
+        else
+            program._stages.push_back({stage, module, std::string(path)});
+    }
+
+    return program;
 }
 
+ShaderProgram ShaderLibrary::Refresh(const ShaderProgram& program)
+{
+    ShaderProgram refreshed{program};
 
+    for(auto& stage : refreshed._stages)
+    {
+        stage.module = Load(stage.path);
+        if(stage.module == VK_NULL_HANDLE)
+            refreshed._valid = false;
+    }
 
+    return refreshed;
+}
+
+ShaderLibrary::Stats ShaderLibrary::stats() const
+{
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
 
+void ShaderLibrary::PrintStats() const
+{
+    std::lock_guard lock(_mutex);
+    fmt::print("| shader library | {} modules | {} B | {} path hits | {} content hits | {} rejected |\n",
+               _stats.modules, _stats.bytes, _stats.pathHits, _stats.contentHits, _stats.rejected);
+}
@@ -2,30 +2,97 @@
 #define VULKANTUT2_SHADER_H
 
 #include <vulkan/vulkan.h>
+#include <initializer_list>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace VulkanTut
 {
-    class ShaderVF
+    ///any combination of stages, modules are owned by the ShaderLibrary that loaded them
+    class ShaderProgram
     {
         public:
-            ShaderVF() = default;
-            ShaderVF(VkDevice device, std::string_view vSh, std::string_view fSh);
+            struct Stage
+            {
+                VkShaderStageFlagBits stage;
+                VkShaderModule module;
+                std::string path;
+            };
 
-            void Delete() const;
+            ShaderProgram() = default;
 
-            [[nodiscard]] auto vertModule() const { return _vshModule; }
-            [[nodiscard]] auto fragModule() const { return _fshModule; }
+            ///entry point "main" for every stage
+            [[nodiscard]] std::vector<VkPipelineShaderStageCreateInfo> StageInfos() const;
+            ///VK_NULL_HANDLE if the program has no such stage
+            [[nodiscard]] VkShaderModule module(VkShaderStageFlagBits stage) const;
+            ///any stage loaded from path
+            [[nodiscard]] bool uses(std::string_view path) const;
+            ///false if any stage failed to load
+            [[nodiscard]] bool valid() const { return _valid && !_stages.empty(); }
 
         private:
-            VkShaderModule CreateModule(const std::vector<char>& code);
+            friend class ShaderLibrary;
+
+            std::vector<Stage> _stages;
+            bool _valid{true};
+    };
+
+    ///SPIR-V is mmapped and validated (size, alignment, magic), modules are deduplicated by path and
+    ///by content hash so pipelines sharing a stage never re-read the file or re-create the module.
+    ///Loading is thread safe, the hot reload thread builds programs while the render thread draws
+    class ShaderLibrary
+    {
+        public:
+            struct Stats
+            {
+                uint32_t modules{0};     ///vkCreateShaderModule calls
+                uint32_t pathHits{0};    ///path seen before, file not touched
+                uint32_t contentHits{0}; ///new path, byte identical to a loaded module
+                uint32_t rejected{0};    ///missing or malformed files
+                size_t bytes{0};         ///SPIR-V handed to the driver
+            };
+
+            ShaderLibrary() = default;
+
+            void Create(VkDevice);
+            ///destroys every module, programs obtained from the library become dangling
+            void Delete();
+
+            ///VK_NULL_HANDLE on failure
+            VkShaderModule Load(std::string_view path);
+            ShaderProgram LoadProgram(std::initializer_list<std::pair<VkShaderStageFlagBits, std::string_view>> stages);
+            ///forgets path and loads it again, modules created before stay alive (pipelines may still use
+            ///them) until Delete, a revert to bytes seen before reuses the old module
+            VkShaderModule Reload(std::string_view path);
+            ///same stages resolved again by path, picks up modules swapped in by Reload
+            ShaderProgram Refresh(const ShaderProgram&);
+
+            void PrintStats() const;
+
+            Stats stats() const;
+
+        private:
+            VkShaderModule LoadLocked(std::string_view path);
 
         private:
-            VkDevice _device;
-            VkShaderModule _vshModule;
-            VkShaderModule _fshModule;
+            struct Module
+            {
+                VkShaderModule module{VK_NULL_HANDLE};
+                size_t size{0};
+            };
+
+            VkDevice _device{VK_NULL_HANDLE};
+            std::unordered_map<std::string, VkShaderModule> _byPath;
+            std::unordered_map<uint64_t, Module> _byContent;
+            std::vector<VkShaderModule> _modules;
+
+            Stats _stats{};
+
+            mutable std::mutex _mutex;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,211 @@
+#include "ShaderReloader.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+using namespace VulkanTut;
+
+namespace
+{
+    ///editors save through several events (truncate + write, temp file + rename), a burst is handled once
+    constexpr int DebounceMs{50};
+
+    std::string Normalize(std::string_view path)
+    {
+        return std::filesystem::path(path).lexically_normal().string();
+    }
+
+    std::string Directory(const std::string& path)
+    {
+        auto dir = std::filesystem::path(path).parent_path().string();
+        return dir.empty() ? std::string(".") : dir;
+    }
+}
+
+bool ShaderReloader::Create(std::string_view compiler, Rebuild rebuild)
+{
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    _wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(_inotify < 0 || _wake < 0)
+    {
+        LOG("could not create the shader watch, hot reload disabled");
+        Delete();
+        return false;
+    }
+
+    _compiler = compiler;
+    _rebuild = std::move(rebuild);
+    _thread = std::thread(&ShaderReloader::WatchLoop, this);
+
+    return true;
+}
+
+void ShaderReloader::Delete()
+{
+    if(_thread.joinable())
+    {
+        const uint64_t one{1};
+        [[maybe_unused]] auto written = write(_wake, &one, sizeof(one));
+        _thread.join();
+    }
+
+    if(_inotify >= 0)
+        close(_inotify);
+    if(_wake >= 0)
+        close(_wake);
+
+    _inotify = -1;
+    _wake = -1;
+    _entries.clear();
+    _directories.clear();
+}
+
+void ShaderReloader::Watch(std::string_view source, std::string_view spirv)
+{
+    if(_inotify < 0)
+        return;
+
+    Entry entry{source.empty() ? std::string() : Normalize(source), Normalize(spirv)};
+
+    std::lock_guard lock(_mutex);
+
+    if(!entry.source.empty())
+        AddDirectoryWatch(entry.source);
+    AddDirectoryWatch(entry.spirv);
+
+    _entries.push_back(std::move(entry));
+}
+
+uint32_t ShaderReloader::Poll()
+{
+    std::vector<Completion> completed;
+    {
+        std::lock_guard lock(_mutex);
+        completed.swap(_completed);
+    }
+
+    for(auto& completion : completed)
+        completion();
+
+    return static_cast<uint32_t>(completed.size());
+}
+
+///called with _mutex held
+void ShaderReloader::AddDirectoryWatch(const std::string& path)
+{
+    auto dir = Directory(path);
+    for(const auto&[wd, watched] : _directories)
+        if(watched == dir)
+            return;
+
+    ///the directory, not the file, renames over the file replace the inode a file watch would follow
+    const int wd = inotify_add_watch(_inotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(wd < 0)
+    {
+        LOG_ARGS("could not watch {}", dir);
+        return;
+    }
+
+    _directories.emplace(wd, std::move(dir));
+}
+
+void ShaderReloader::WatchLoop()
+{
+    std::array<pollfd, 2> fds{{{_inotify, POLLIN, 0}, {_wake, POLLIN, 0}}};
+    alignas(inotify_event) char buffer[4096];
+
+    while(true)
+    {
+        if(poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            LOG("shader watch poll failed, hot reload stopped");
+            return;
+        }
+
+        std::vector<std::string> changed;
+        int timeout{-1};
+
+        do
+        {
+            if(fds[1].revents & POLLIN)
+                return;
+
+            ssize_t length{0};
+            while((length = read(_inotify, buffer, sizeof(buffer))) > 0)
+            {
+                for(ssize_t offset{0}; offset<length; )
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                    if(event->len == 0)
+                        continue;
+
+                    std::lock_guard lock(_mutex);
+                    if(auto it = _directories.find(event->wd); it != _directories.end())
+                    {
+                        auto path = Normalize((std::filesystem::path(it->second) / event->name).string());
+                        if(std::find(changed.begin(), changed.end(), path) == changed.end())
+                            changed.push_back(std::move(path));
+                    }
+                }
+            }
+
+            timeout = DebounceMs;
+        }
+        while(poll(fds.data(), fds.size(), timeout) > 0);
+
+        Handle(changed);
+    }
+}
+
+void ShaderReloader::Handle(const std::vector<std::string>& changed)
+{
+    std::vector<Entry> entries;
+    {
+        std::lock_guard lock(_mutex);
+        entries = _entries;
+    }
+
+    std::vector<Completion> completed;
+
+    for(const auto& path : changed)
+    {
+        for(const auto& entry : entries)
+        {
+            ///the compiler writing the SPIR-V is picked up as a SPIR-V change by the next wakeup
+            if(path == entry.source && !_compiler.empty())
+            {
+                auto command = fmt::format("\"{}\" \"{}\" -o \"{}\"", _compiler, entry.source, entry.spirv);
+                if(std::system(command.c_str()) != 0)
+                {
+                    LOG_ARGS("{} failed to compile, keeping the running pipelines", entry.source);
+                }
+            }
+
+            if(path == entry.spirv)
+            {
+                if(auto completion = _rebuild(entry.spirv))
+                    completed.push_back(std::move(completion));
+                break;
+            }
+        }
+    }
+
+    std::lock_guard lock(_mutex);
+    std::move(completed.begin(), completed.end(), std::back_inserter(_completed));
+}
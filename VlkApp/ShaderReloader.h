@@ -0,0 +1,64 @@
+#ifndef VULKANTUT2_SHADERRELOADER_H
+#define VULKANTUT2_SHADERRELOADER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanTut
+{
+    ///watches shader sources and their SPIR-V with inotify on a background thread. A changed source is
+    ///recompiled into its SPIR-V, a changed SPIR-V runs the rebuild callback on the same thread. The
+    ///callback returns a completion which, like AssetLoader's, only runs in Poll() on the render thread
+    class ShaderReloader
+    {
+        public:
+            using Completion = std::function<void()>;
+            using Rebuild = std::function<Completion(const std::string& spirvPath)>;
+
+            ShaderReloader() = default;
+
+            ///compiler is invoked as "<compiler> <source> -o <spirv>", empty only watches the SPIR-V
+            bool Create(std::string_view compiler, Rebuild rebuild);
+            ///joins the thread, completions already produced are kept for a last Poll
+            void Delete();
+
+            ///source may be empty when the SPIR-V is produced elsewhere
+            void Watch(std::string_view source, std::string_view spirv);
+
+            ///runs the completions of every finished rebuild, returns how many ran
+            uint32_t Poll();
+
+            bool isActive() const { return _thread.joinable(); }
+
+        private:
+            void AddDirectoryWatch(const std::string& path);
+            void WatchLoop();
+            void Handle(const std::vector<std::string>& changed);
+
+        private:
+            struct Entry
+            {
+                std::string source;
+                std::string spirv;
+            };
+
+            int _inotify{-1};
+            int _wake{-1}; ///eventfd, signalled by Delete
+            std::string _compiler;
+            Rebuild _rebuild;
+            std::thread _thread;
+
+            std::vector<Entry> _entries;
+            std::unordered_map<int, std::string> _directories; ///watch descriptor -> directory
+            std::vector<Completion> _completed;
+
+            std::mutex _mutex;
+    };
+}
+
+#endif
@@ -11,7 +11,8 @@ void VlkApp::CreateSwapChain(int32_t wpx, int32_t hpx, VkSwapchainKHR oldSwapcha
     auto presentationMode = ChooseSwapPresentMode(swapChainSupportDetails.presentationModes);
     auto extent = ChooseSwapExtent(swapChainSupportDetails.capabilities, wpx, hpx);
 
-    auto imageCount = swapChainSupportDetails.capabilities.minImageCount + 1;
+    ///deeper chains let more frames queue for presentation, shallower ones show them sooner
+    auto imageCount = swapChainSupportDetails.capabilities.minImageCount + GetLatencyConfig(_latencyProfile).extraSwapchainImages;
     if(swapChainSupportDetails.capabilities.maxImageCount > 0 &&
        swapChainSupportDetails.capabilities.maxImageCount < imageCount)
         imageCount = swapChainSupportDetails.capabilities.maxImageCount;
@@ -61,50 +62,55 @@ void VlkApp::CreateSwapChain(int32_t wpx, int32_t hpx, VkSwapchainKHR oldSwapcha
 
     _swapChainExtent = extent;
     _swapChainImageFormat = surfaceFormat.format;
+
+    ///a latency profile switch recreates the swapchain without a resize event
+    _recreationInfo.wpx = wpx;
+    _recreationInfo.hpx = hpx;
 }
 
 
 void VlkApp::RecreateSwapchain()
 {
-    vkDeviceWaitIdle(_device);
+    ///no device idle, the frame being built and the ones in flight may still reference the old
+    ///extent dependent objects so they are retired and destroyed once those frames completed
+    const auto safeAfter = _frameNumber + 1;
 
-    vkDestroyImageView(_device, _depthImgView, nullptr);
-    vkDestroyImage(_device, _depthImg, nullptr);
-    vkFreeMemory(_device, _depthImgMemory, nullptr);
+    _deletionQueue.Push(safeAfter, [this, depthView = _depthImgView, depthImg = _depthImg, depthMem = _depthImgMemory,
+                                    fbos = _swapChainFbos, views = _swapChainImageViews, swapchain = _swapChain]()
+    {
+        vkDestroyImageView(_device, depthView, nullptr);
+        _allocator.DestroyImage(depthImg, depthMem);
 
-    for(auto fbo : _swapChainFbos)
-        vkDestroyFramebuffer(_device, fbo, nullptr);
+        for(auto fbo : fbos)
+            vkDestroyFramebuffer(_device, fbo, nullptr);
 
-    vkFreeCommandBuffers(_device, _cmdPool, _cmdBuffers.size(), _cmdBuffers.data());
+        for(auto imgView : views)
+            vkDestroyImageView(_device, imgView, nullptr);
 
-    vkDestroyPipeline(_device, _pipeline, nullptr);
-    vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
-    vkDestroyRenderPass(_device, _renderPass, nullptr);
+        vkDestroySwapchainKHR(_device, swapchain, nullptr);
+    });
 
-    for(auto imgView : _swapChainImageViews)
-        vkDestroyImageView(_device, imgView, nullptr);
+    auto oldFormat = _swapChainImageFormat;
+    CreateSwapChain(_recreationInfo.wpx, _recreationInfo.hpx, _swapChain);
 
-    for(size_t i{0}; i<_swapChainImages.size(); ++i)
-    {
-        vkDestroyBuffer(_device, _uboBuffs[i], nullptr);
-        vkFreeMemory(_device, _uboBuffsMem[i], nullptr);
-    }
+    CreateImageViews();
 
-    vkDestroyDescriptorPool(_device, _descPool, nullptr);
+    ///viewport/scissor are dynamic, render pass and pipeline only go stale when the surface format changes
+    if(_swapChainImageFormat != oldFormat)
+    {
+        RetirePipelineVariants(safeAfter);
+        _deletionQueue.Push(safeAfter, [this, renderPass = _renderPass]()
+        {
+            vkDestroyRenderPass(_device, renderPass, nullptr);
+        });
 
-    auto oldSwapchain = _swapChain;
-    CreateSwapChain(_recreationInfo.wpx, _recreationInfo.hpx, oldSwapchain);
-    vkDestroySwapchainKHR(_device, oldSwapchain, nullptr);
+        std::lock_guard lock(_renderPassMutex);
+        CreateRenderPass();
+        CreatePipeline();
+    }
 
-    CreateImageViews();
-    CreateRenderPass();
-    CreatePipeline();
     CreateDepthBuffer();
     CreateSchFramebuffers();
-    CreateUniformBuffers();
-    CreateDescriptorPool();
-    CreateDescriptorSets();
-    CreateCommandBuffers();
 }
 
 
@@ -149,11 +155,12 @@ VkSurfaceFormatKHR VlkApp::ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFo
     return avFormats[0];
 }
 
-VkPresentModeKHR VlkApp::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &avPresModes)
+VkPresentModeKHR VlkApp::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &avPresModes) const
 {
-    for(const auto& mode : avPresModes)
-        if(mode == VK_PRESENT_MODE_MAILBOX_KHR)
-            return mode;
+    for(auto preferred : GetLatencyConfig(_latencyProfile).presentModes)
+        for(const auto& mode : avPresModes)
+            if(mode == preferred)
+                return mode;
 
     return VK_PRESENT_MODE_FIFO_KHR;
 }
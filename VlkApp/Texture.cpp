@@ -1,38 +1,230 @@
 #include "VlkApp.h"
 #include "errLog.h"
+#include "MipGen.h"
+
+#include <algorithm>
 
 using namespace VulkanTut;
 
-void VlkApp::CreateTexture(Img&& img)
+void VlkApp::CreatePlaceholderTexture(uint32_t slots)
 {
-    auto[stagingBuff, stagingBuffMem] = CreateBuffer(img.pixels.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|
-                                                     VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    ///2x2 grey checker, shown until a streamed texture lands
+    constexpr std::array<ubyte, 16> pixels
+    {
+        0x80, 0x80, 0x80, 0xFF,  0x40, 0x40, 0x40, 0xFF,
+        0x40, 0x40, 0x40, 0xFF,  0x80, 0x80, 0x80, 0xFF
+    };
 
-    void* data;
-    vkMapMemory(_device, stagingBuffMem, 0, img.pixels.size(), 0, &data);
+    _placeholderTex = CreateTextureRGBA8(pixels.data(), 2, 2);
 
-    memcpy(data, img.pixels.data(), img.pixels.size());
+    slots = std::max(slots, 1u);
+    if(_bindless && slots > _bindlessCapacity)
+    {
+        LOG_ARGS("{} texture slots exceed the bindless array, clamped to {}", slots, _bindlessCapacity);
+        slots = _bindlessCapacity;
+    }
 
-    vkUnmapMemory(_device, stagingBuffMem);
+    _textures.resize(slots);
+    for(auto& slot : _textures)
+        slot.tex = _placeholderTex;
+}
 
+VlkApp::Texture VlkApp::CreateTextureRGBA8(const ubyte* pixels, uint32_t w, uint32_t h)
+{
+    Texture tex{};
+    tex.format = VK_FORMAT_R8G8B8A8_SRGB;
+    tex.mipLevels = MipLevelCount(w, h);
+
+    ///blit generated chain needs linear filtered blits of the format, otherwise the chain is built on the cpu
+    VkFormatProperties formatProps{};
+    vkGetPhysicalDeviceFormatProperties(_physicalDevice, tex.format, &formatProps);
 
-    auto[vkimg, imgMemory] = CreateImage(img.width, img.height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    constexpr VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT|VK_FORMAT_FEATURE_BLIT_DST_BIT|
+                                                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    const bool gpuMips = (formatProps.optimalTilingFeatures & blitFeatures) == blitFeatures;
 
-    _texImg = vkimg;
-    _texMem = imgMemory;
+    VkImageUsageFlags usage{VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT};
+    if(gpuMips)
+        usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-    TransitionImageLayout(vkimg, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    std::tie(tex.img, tex.mem) = CreateImage(w, h, tex.format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                             VK_SHARING_MODE_EXCLUSIVE, tex.mipLevels);
 
-    CopyBufferToImage(stagingBuff, vkimg, img.width, img.height);
+    if(gpuMips)
+    {
+        _uploads.CopyToImage(pixels, VkDeviceSize{w} * h * 4, tex.img, {ImageLevel{0, w, h}}, tex.mipLevels,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+    else
+    {
+        auto levels = MipChainLevelsRGBA8(w, h, tex.mipLevels);
+        auto staging = _uploads.Reserve(MipChainSizeRGBA8(levels));
+        BuildMipChainRGBA8(pixels, levels, static_cast<uint8_t*>(staging.mapped));
 
-    TransitionImageLayout(vkimg, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        _uploads.CopyToImage(staging, tex.img, levels, tex.mipLevels,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
 
-    vkDestroyBuffer(_device, stagingBuff, nullptr);
-    vkFreeMemory(_device, stagingBuffMem, nullptr);
+    return tex;
 }
 
-VkImageView VlkApp::CreateImageView(VkImage img, VkFormat format, VkImageAspectFlags aspectFlags)
+std::optional<VlkApp::Texture> VlkApp::CreateCompressedTexture(CompressedImg&& img)
+{
+    if(!img.valid())
+        return std::nullopt;
+
+    if(FindSupportedFormat({img.format}, VK_IMAGE_TILING_OPTIMAL,
+                           VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT|VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != img.format)
+    {
+        LOG_ARGS("compressed format {} isn't sampleable on this device", static_cast<int32_t>(img.format));
+        return std::nullopt;
+    }
+
+    Texture tex{};
+    tex.format = img.format;
+    tex.mipLevels = static_cast<uint32_t>(img.levels.size());
+
+    ///blocks can't be blitted, only the levels shipped in the file are used
+    std::vector<ImageLevel> levels;
+    levels.reserve(img.levels.size());
+    for(const auto& level : img.levels)
+        levels.push_back({level.offset, level.width, level.height});
+
+    std::tie(tex.img, tex.mem) = CreateImage(img.width, img.height, tex.format, VK_IMAGE_TILING_OPTIMAL,
+                                             VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                             VK_SHARING_MODE_EXCLUSIVE, tex.mipLevels);
+
+    _uploads.CopyToImage(img.data(), img.size(), tex.img, levels, tex.mipLevels,
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    return tex;
+}
+
+void VlkApp::StreamTexture(uint32_t slot, Img&& img)
+{
+    if(!img.valid() || slot >= _textures.size())
+        return;
+
+    BeginTextureSwap(slot, CreateTextureRGBA8(img.pixels.get(), static_cast<uint32_t>(img.width), static_cast<uint32_t>(img.height)));
+}
+
+bool VlkApp::StreamTexture(uint32_t slot, CompressedImg&& img)
+{
+    if(slot >= _textures.size())
+        return false;
+
+    auto tex = CreateCompressedTexture(std::move(img));
+    if(!tex.has_value())
+        return false;
+
+    BeginTextureSwap(slot, tex.value());
+    return true;
+}
+
+void VlkApp::BeginTextureSwap(uint32_t slot, Texture tex)
+{
+    tex.view = CreateImageView(tex.img, tex.format, VK_IMAGE_ASPECT_COLOR_BIT, tex.mipLevels);
+
+    auto& textureSlot = _textures[slot];
+    textureSlot.retired.push_back(textureSlot.tex);
+    textureSlot.tex = tex;
+    textureSlot.ticket = _uploads.Submit();
+
+    ///sets may be bound by frames in flight, each one is rewritten after its slot's previous frame retired
+    std::fill_n(textureSlot.stale.begin(), _framesInFlight, true);
+}
+
+void VlkApp::WriteTextureDescriptors(uint32_t frame, uint32_t slot)
+{
+    ///slot 0 doubles as the classic single texture binding, its set is immutable and cached,
+    ///the frame switches over to the set of the new texture instead of rewriting a shared one
+    if(slot == 0)
+        _descSets[frame] = GetMainSet();
+
+    if(!_bindless)
+        return;
+
+    VkDescriptorImageInfo imgInfo{};
+    imgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imgInfo.imageView = _textures[slot].tex.view;
+    imgInfo.sampler = _texSampler;
+
+    VkWriteDescriptorSet descWrite{};
+    descWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descWrite.dstSet = _bindlessSets[frame];
+    descWrite.dstBinding = 0;
+    descWrite.dstArrayElement = slot;
+    descWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descWrite.descriptorCount = 1;
+    descWrite.pImageInfo = &imgInfo;
+
+    vkUpdateDescriptorSets(_device, 1, &descWrite, 0, nullptr);
+}
+
+void VlkApp::UpdateTextureDescriptors(uint32_t frame)
+{
+    bool retired{false};
+
+    for(uint32_t i{0}; i<_textures.size(); ++i)
+    {
+        auto& slot = _textures[i];
+        if(!slot.stale[frame] || !_uploads.IsComplete(slot.ticket))
+            continue;
+
+        WriteTextureDescriptors(frame, i);
+        slot.stale[frame] = false;
+
+        if(std::find(slot.stale.begin(), slot.stale.end(), true) != slot.stale.end())
+            continue;
+
+        ///frames before this one may still sample the old textures
+        for(const auto& tex : slot.retired)
+        {
+            if(tex.img == _placeholderTex.img)
+                continue;
+
+            _deletionQueue.Push(_frameNumber, [this, tex]()
+            {
+                DestroyTexture(tex);
+            });
+        }
+
+        slot.retired.clear();
+        retired = true;
+    }
+
+    if(retired)
+        _uploads.Collect();
+}
+
+void VlkApp::DestroyTexture(const Texture& tex)
+{
+    _descriptorCache.EvictImageView(tex.view);
+    vkDestroyImageView(_device, tex.view, nullptr);
+    _allocator.DestroyImage(tex.img, tex.mem);
+}
+
+void VlkApp::DeleteTextures()
+{
+    vkDestroySampler(_device, _texSampler, nullptr);
+
+    for(const auto& slot : _textures)
+    {
+        for(const auto& tex : slot.retired)
+            if(tex.img != _placeholderTex.img)
+                DestroyTexture(tex);
+
+        if(slot.tex.img != _placeholderTex.img)
+            DestroyTexture(slot.tex);
+    }
+    _textures.clear();
+
+    if(_placeholderTex.img != VK_NULL_HANDLE)
+        DestroyTexture(_placeholderTex);
+    _placeholderTex = {};
+}
+
+VkImageView VlkApp::CreateImageView(VkImage img, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 {
     VkImageView imgView;
 
@@ -43,7 +235,7 @@ VkImageView VlkApp::CreateImageView(VkImage img, VkFormat format, VkImageAspectF
     imageViewCreateInfo.format = format;
     imageViewCreateInfo.subresourceRange.aspectMask = aspectFlags;
     imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-    imageViewCreateInfo.subresourceRange.levelCount = 1;
+    imageViewCreateInfo.subresourceRange.levelCount = mipLevels;
     imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
     imageViewCreateInfo.subresourceRange.layerCount = 1;
 
@@ -58,7 +250,16 @@ VkImageView VlkApp::CreateImageView(VkImage img, VkFormat format, VkImageAspectF
 
 void VlkApp::CreateTextureImageView()
 {
-    _texImgView = CreateImageView(_texImg, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    if(_placeholderTex.img != VK_NULL_HANDLE && _placeholderTex.view == VK_NULL_HANDLE)
+        _placeholderTex.view = CreateImageView(_placeholderTex.img, _placeholderTex.format, VK_IMAGE_ASPECT_COLOR_BIT, _placeholderTex.mipLevels);
+
+    for(auto& slot : _textures)
+    {
+        if(slot.tex.img == _placeholderTex.img)
+            slot.tex.view = _placeholderTex.view;
+        else if(slot.tex.view == VK_NULL_HANDLE)
+            slot.tex.view = CreateImageView(slot.tex.img, slot.tex.format, VK_IMAGE_ASPECT_COLOR_BIT, slot.tex.mipLevels);
+    }
 }
 
 
@@ -83,7 +284,8 @@ void VlkApp::CreateTextureSampler()
     samplerCreateInfo.mipmapMode= VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerCreateInfo.mipLodBias = .0f;
     samplerCreateInfo.minLod = .0f;
-    samplerCreateInfo.maxLod = .0f;
+    ///streamed textures replace the view under the same sampler, the view's level count is the only limit
+    samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
 
     if(vkCreateSampler(_device, &samplerCreateInfo, nullptr, &_texSampler) != VK_SUCCESS)
     {
@@ -0,0 +1,81 @@
+#include "TimelineSemaphore.h"
+#include "errLog.h"
+
+#include <algorithm>
+
+using namespace VulkanTut;
+
+bool TimelineSemaphore::Create(VkDevice device, uint64_t initialValue)
+{
+    _device = device;
+    _completed = initialValue;
+
+    _waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR"));
+    _getCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(_device, "vkGetSemaphoreCounterValueKHR"));
+
+    if(_waitSemaphores == nullptr || _getCounterValue == nullptr)
+    {
+        LOG("VK_KHR_timeline_semaphore entry points missing, was the extension enabled?");
+        return false;
+    }
+
+    VkSemaphoreTypeCreateInfo typeCreateInfo{};
+    typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeCreateInfo.initialValue = initialValue;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo{};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &typeCreateInfo;
+
+    if(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_semaphore) != VK_SUCCESS)
+    {
+        LOG("timeline semaphore creation failed");
+        _semaphore = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+void TimelineSemaphore::Delete()
+{
+    if(_semaphore != VK_NULL_HANDLE)
+        vkDestroySemaphore(_device, _semaphore, nullptr);
+
+    _semaphore = VK_NULL_HANDLE;
+}
+
+uint64_t TimelineSemaphore::Query()
+{
+    uint64_t value{0};
+    if(_getCounterValue(_device, _semaphore, &value) == VK_SUCCESS)
+        _completed = std::max(_completed, value);
+
+    return _completed;
+}
+
+bool TimelineSemaphore::Reached(uint64_t value)
+{
+    return value <= _completed || value <= Query();
+}
+
+void TimelineSemaphore::Wait(uint64_t value)
+{
+    if(value <= _completed)
+        return;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &_semaphore;
+    waitInfo.pValues = &value;
+
+    if(_waitSemaphores(_device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+    {
+        LOG_ARGS("wait for timeline value {} failed", value);
+        return;
+    }
+
+    _completed = value;
+}
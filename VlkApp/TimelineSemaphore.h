@@ -0,0 +1,41 @@
+#ifndef VULKANTUT2_TIMELINESEMAPHORE_H
+#define VULKANTUT2_TIMELINESEMAPHORE_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace VulkanTut
+{
+    ///one VK_KHR_timeline_semaphore counter. Work submitted in order signals increasing values, so a single
+    ///value tells how much of it finished. The last value read is cached, queries it already answers are free
+    class TimelineSemaphore
+    {
+        public:
+            TimelineSemaphore() = default;
+
+            bool Create(VkDevice, uint64_t initialValue = 0);
+            void Delete();
+
+            ///reads the counter
+            uint64_t Query();
+            ///counter >= value, only reads the counter when the cached value is behind
+            bool Reached(uint64_t value);
+            ///blocks until counter >= value
+            void Wait(uint64_t value);
+
+            auto semaphore() const { return _semaphore; }
+            auto completed() const { return _completed; } ///last value read, may lag the counter
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            VkSemaphore _semaphore{VK_NULL_HANDLE};
+
+            ///KHR entry points, the instance stays on 1.1 where the core 1.2 names are not guaranteed
+            PFN_vkWaitSemaphoresKHR _waitSemaphores{nullptr};
+            PFN_vkGetSemaphoreCounterValueKHR _getCounterValue{nullptr};
+
+            uint64_t _completed{0};
+    };
+}
+
+#endif
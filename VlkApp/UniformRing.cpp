@@ -0,0 +1,66 @@
+#include "UniformRing.h"
+#include "errLog.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace VulkanTut;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void UniformRing::Create(DeviceAllocator& allocator, VkPhysicalDevice pDevice, VkDeviceSize segmentSize, uint32_t segmentCount)
+{
+    _allocator = &allocator;
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(pDevice, &properties);
+    _alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+
+    _segmentSize = AlignUp(segmentSize, _alignment);
+    _segmentCount = segmentCount;
+
+    auto[buff, memory] = _allocator->CreateBuffer(_segmentSize * _segmentCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    _buffer = buff;
+    _memory = memory;
+
+    if(!_memory.mapped)
+    {
+        LOG("uniform ring memory is not host visible");
+    }
+}
+
+void UniformRing::Delete()
+{
+    if(_allocator)
+        _allocator->DestroyBuffer(_buffer, _memory);
+
+    _buffer = VK_NULL_HANDLE;
+    _memory = {};
+}
+
+void UniformRing::BeginFrame(uint32_t frame)
+{
+    _segmentBegin = _segmentSize * (frame % _segmentCount);
+    _head = _segmentBegin;
+}
+
+std::optional<uint32_t> UniformRing::Push(const void* data, VkDeviceSize size)
+{
+    const auto offset = AlignUp(_head, _alignment);
+
+    ///wrapping would overwrite uniforms the frame already references
+    if(offset + size > _segmentBegin + _segmentSize)
+    {
+        LOG_ARGS("uniform ring segment of {} bytes is full, {} more bytes rejected", _segmentSize, size);
+        return std::nullopt;
+    }
+
+    std::memcpy(static_cast<char*>(_memory.mapped) + offset, data, size);
+    _head = offset + size;
+
+    return static_cast<uint32_t>(offset);
+}
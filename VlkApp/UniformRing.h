@@ -0,0 +1,49 @@
+#ifndef VULKANTUT2_UNIFORMRING_H
+#define VULKANTUT2_UNIFORMRING_H
+
+#include <vulkan/vulkan.h>
+#include <optional>
+
+#include "DeviceAllocator.h"
+
+namespace VulkanTut
+{
+    ///one persistently mapped host coherent buffer split into a segment per frame in flight,
+    ///uniform data is bump allocated from the current segment and bound with dynamic offsets
+    class UniformRing
+    {
+        public:
+            UniformRing() = default;
+
+            void Create(DeviceAllocator&, VkPhysicalDevice, VkDeviceSize segmentSize, uint32_t segmentCount);
+            void Delete();
+
+            ///rewinds the segment of the given frame, its previous contents must no longer be in use by the gpu
+            void BeginFrame(uint32_t frame);
+
+            ///copies data into the current segment and returns its dynamic offset,
+            ///nullopt when the segment is full, the data pushed before stays intact
+            std::optional<uint32_t> Push(const void* data, VkDeviceSize size);
+
+            template<typename T>
+            std::optional<uint32_t> Push(const T& data) { return Push(&data, sizeof(T)); }
+
+            auto buffer() const { return _buffer; }
+            auto segmentSize() const { return _segmentSize; }
+
+        private:
+            DeviceAllocator* _allocator{nullptr};
+
+            VkBuffer _buffer{VK_NULL_HANDLE};
+            Allocation _memory{};
+
+            VkDeviceSize _alignment{1};
+            VkDeviceSize _segmentSize{0};
+            uint32_t _segmentCount{0};
+
+            VkDeviceSize _segmentBegin{0};
+            VkDeviceSize _head{0};
+    };
+}
+
+#endif
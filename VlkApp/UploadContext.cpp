@@ -0,0 +1,526 @@
+#include "UploadContext.h"
+#include "errLog.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace VulkanTut;
+
+static VkCommandPool CreatePool(VkDevice device, uint32_t queueFamily)
+{
+    VkCommandPool cmdPool{VK_NULL_HANDLE};
+
+    VkCommandPoolCreateInfo cmdPoolCreateInfo{};
+    cmdPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolCreateInfo.queueFamilyIndex = queueFamily;
+    cmdPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    if(vkCreateCommandPool(device, &cmdPoolCreateInfo, nullptr, &cmdPool) != VK_SUCCESS)
+    {
+        LOG_ARGS("upload command pool creation for family {} failed", queueFamily);
+    }
+
+    return cmdPool;
+}
+
+void UploadContext::Create(VkDevice device, DeviceAllocator& allocator, VkQueue transferQueue, uint32_t transferFamily,
+                           VkQueue graphicsQueue, uint32_t graphicsFamily, VkDeviceSize stagingArenaSize)
+{
+    _device = device;
+    _allocator = &allocator;
+
+    _dedicated = transferFamily != graphicsFamily;
+    _transferFamily = transferFamily;
+    _graphicsFamily = graphicsFamily;
+    _graphicsQueue = graphicsQueue;
+    _transferQueue = _dedicated ? transferQueue : graphicsQueue;
+
+    ///tickets are the values the batches signal
+    if(!_timeline.Create(_device, _nextTicket - 1))
+    {
+        LOG("upload timeline creation failed");
+    }
+
+    _transferCmdPool = CreatePool(_device, _dedicated ? _transferFamily : _graphicsFamily);
+    if(_dedicated)
+        _graphicsCmdPool = CreatePool(_device, _graphicsFamily);
+
+    _arenaSize = stagingArenaSize;
+    _arenaHead = 0;
+    _arenaUsed = 0;
+    std::tie(_arena, _arenaMemory) = _allocator->CreateBuffer(_arenaSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if(_arena == VK_NULL_HANDLE || _arenaMemory.mapped == nullptr)
+    {
+        LOG("staging arena creation failed, every upload gets its own staging buffer");
+        _arenaSize = 0;
+    }
+}
+
+void UploadContext::Delete()
+{
+    if(_recording.cmdBuff != VK_NULL_HANDLE)
+        Wait(Submit());
+
+    Wait(lastSubmitted());
+    for(auto& batch : _inFlight)
+        Retire(batch);
+    _inFlight.clear();
+
+    if(_arena != VK_NULL_HANDLE)
+        _allocator->DestroyBuffer(_arena, _arenaMemory);
+    _arena = VK_NULL_HANDLE;
+
+    _timeline.Delete();
+
+    for(auto semaphore : _freeSemaphores)
+        vkDestroySemaphore(_device, semaphore, nullptr);
+    _freeSemaphores.clear();
+
+    vkDestroyCommandPool(_device, _transferCmdPool, nullptr);
+    if(_graphicsCmdPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(_device, _graphicsCmdPool, nullptr);
+}
+
+VkCommandBuffer UploadContext::BeginCmdBuff(VkCommandPool cmdPool)
+{
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = cmdPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cmdBuff{VK_NULL_HANDLE};
+    if(vkAllocateCommandBuffers(_device, &allocInfo, &cmdBuff) != VK_SUCCESS)
+    {
+        LOG("allocation of upload cmd buffer failed");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(cmdBuff, &beginInfo);
+
+    return cmdBuff;
+}
+
+VkCommandBuffer UploadContext::Recording()
+{
+    if(_recording.cmdBuff == VK_NULL_HANDLE)
+        _recording.cmdBuff = BeginCmdBuff(_transferCmdPool);
+
+    return _recording.cmdBuff;
+}
+
+bool UploadContext::ReserveInArena(VkDeviceSize size, StagingSpan& span)
+{
+    if(_arenaSize == 0 || size > _arenaSize)
+        return false;
+
+    if(_arenaUsed == 0)
+        _arenaHead = 0;
+
+    ///a span never straddles the end, on wrap the skipped tail counts as used until this batch retires
+    auto offset = (_arenaHead + StagingAlignment - 1) & ~(StagingAlignment - 1);
+    if(offset + size > _arenaSize)
+        offset = 0;
+
+    const auto consumed = (offset >= _arenaHead ? offset - _arenaHead : _arenaSize - _arenaHead) + size;
+    if(_arenaUsed + consumed > _arenaSize)
+        return false;
+
+    _arenaHead = offset + size;
+    _arenaUsed += consumed;
+    _recording.arenaBytes += consumed;
+
+    span = {_arena, offset, size, static_cast<char*>(_arenaMemory.mapped) + offset};
+    return true;
+}
+
+StagingSpan UploadContext::Reserve(VkDeviceSize size)
+{
+    Recording();
+
+    StagingSpan span{};
+    if(ReserveInArena(size, span))
+        return span;
+
+    ///older batches give their part of the ring back, the recording batch can't be waited on
+    while(!_inFlight.empty())
+    {
+        Wait(_inFlight.front().ticket);
+        Collect();
+
+        if(ReserveInArena(size, span))
+            return span;
+    }
+
+    LOG_ARGS("{} B don't fit the {} B staging arena, using a dedicated staging buffer", size, _arenaSize);
+
+    auto staging = _allocator->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    _recording.staging.push_back(staging);
+
+    span = {std::get<0>(staging), 0, size, std::get<1>(staging).mapped};
+    return span;
+}
+
+StagingSpan UploadContext::Stage(const void* data, VkDeviceSize size)
+{
+    auto span = Reserve(size);
+    std::memcpy(span.mapped, data, size);
+
+    return span;
+}
+
+void UploadContext::CopyToBuffer(const void* data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset,
+                                 VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+    auto span = Stage(data, size);
+    auto cmdBuff = Recording();
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = span.offset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+
+    vkCmdCopyBuffer(cmdBuff, span.buffer, dst, 1, &copyRegion);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.buffer = dst;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if(_dedicated)
+    {
+        ///release, dst access is ignored on the releasing queue
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = _transferFamily;
+        barrier.dstQueueFamilyIndex = _graphicsFamily;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        _recording.bufferAcquires.push_back(barrier);
+        _recording.acquireStages |= dstStage;
+    }
+    else
+    {
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+}
+
+void UploadContext::CopyToImage(const void* data, VkDeviceSize size, VkImage dst, uint32_t w, uint32_t h, VkImageLayout finalLayout,
+                                VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+    CopyToImage(data, size, dst, {ImageLevel{0, w, h}}, 1, finalLayout, dstAccess, dstStage);
+}
+
+void UploadContext::CopyToImage(const void* data, VkDeviceSize size, VkImage dst, const std::vector<ImageLevel>& levels, uint32_t mipLevels,
+                                VkImageLayout finalLayout, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+    CopyToImage(Stage(data, size), dst, levels, mipLevels, finalLayout, dstAccess, dstStage);
+}
+
+void UploadContext::CopyToImage(const StagingSpan& span, VkImage dst, const std::vector<ImageLevel>& levels, uint32_t mipLevels,
+                                VkImageLayout finalLayout, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+    auto cmdBuff = Recording();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = dst;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    std::vector<VkBufferImageCopy> regions(levels.size());
+    for(uint32_t i{0}; i<regions.size(); ++i)
+    {
+        regions[i].bufferOffset = span.offset + levels[i].offset;
+        regions[i].bufferRowLength = 0;
+        regions[i].bufferImageHeight = 0;
+        regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[i].imageSubresource.mipLevel = i;
+        regions[i].imageSubresource.baseArrayLayer = 0;
+        regions[i].imageSubresource.layerCount = 1;
+        regions[i].imageOffset = {0, 0, 0};
+        regions[i].imageExtent = {levels[i].width, levels[i].height, 1};
+    }
+
+    vkCmdCopyBufferToImage(cmdBuff, span.buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+    const bool generate = levels.size() < mipLevels;
+    MipChain chain{dst, levels.back().width, levels.back().height, static_cast<uint32_t>(levels.size()), mipLevels,
+                   finalLayout, dstAccess, dstStage};
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if(_dedicated)
+    {
+        ///release with the layout change, the acquire repeats the same transition,
+        ///blits need a graphics queue so a generated chain is handed over still in TRANSFER_DST
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = generate ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : finalLayout;
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = _transferFamily;
+        barrier.dstQueueFamilyIndex = _graphicsFamily;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = generate ? VK_ACCESS_TRANSFER_READ_BIT|VK_ACCESS_TRANSFER_WRITE_BIT : dstAccess;
+        _recording.imageAcquires.push_back(barrier);
+        _recording.acquireStages |= generate ? VkPipelineStageFlags{VK_PIPELINE_STAGE_TRANSFER_BIT} : dstStage;
+
+        if(generate)
+            _recording.mipChains.push_back(chain);
+    }
+    else if(generate)
+    {
+        RecordMipChain(cmdBuff, chain);
+    }
+    else
+    {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = finalLayout;
+        barrier.dstAccessMask = dstAccess;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+void UploadContext::RecordMipChain(VkCommandBuffer cmdBuff, const MipChain& chain)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = chain.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    auto mipW = static_cast<int32_t>(chain.width);
+    auto mipH = static_cast<int32_t>(chain.height);
+
+    for(uint32_t level{chain.firstLevel}; level<chain.mipLevels; ++level)
+    {
+        ///previous level becomes the blit source
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        const auto nextW = std::max(mipW / 2, 1);
+        const auto nextH = std::max(mipH / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipW, mipH, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {nextW, nextH, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(cmdBuff, chain.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, chain.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = chain.finalLayout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = chain.dstAccess;
+
+        vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, chain.dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        mipW = nextW;
+        mipH = nextH;
+    }
+
+    ///the last level was only written, uploaded levels before firstLevel - 1 were never blit sources
+    std::array<VkImageMemoryBarrier, 2> tails{barrier, barrier};
+    uint32_t tailCount{0};
+
+    tails[tailCount].subresourceRange.baseMipLevel = chain.mipLevels - 1;
+    tails[tailCount].subresourceRange.levelCount = 1;
+    ++tailCount;
+
+    if(chain.firstLevel > 1)
+    {
+        tails[tailCount].subresourceRange.baseMipLevel = 0;
+        tails[tailCount].subresourceRange.levelCount = chain.firstLevel - 1;
+        ++tailCount;
+    }
+
+    for(uint32_t i{0}; i<tailCount; ++i)
+    {
+        tails[i].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        tails[i].newLayout = chain.finalLayout;
+        tails[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        tails[i].dstAccessMask = chain.dstAccess;
+    }
+
+    vkCmdPipelineBarrier(cmdBuff, VK_PIPELINE_STAGE_TRANSFER_BIT, chain.dstStage, 0, 0, nullptr, 0, nullptr, tailCount, tails.data());
+}
+
+UploadTicket UploadContext::Submit()
+{
+    if(_recording.cmdBuff == VK_NULL_HANDLE)
+        return lastSubmitted();
+
+    vkEndCommandBuffer(_recording.cmdBuff);
+
+    _recording.ticket = _nextTicket++;
+
+    ///the last submission of the batch signals its ticket on the timeline
+    const auto timeline = _timeline.semaphore();
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &_recording.ticket;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &_recording.cmdBuff;
+
+    if(!_dedicated)
+    {
+        submitInfo.pNext = &timelineSubmitInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timeline;
+
+        if(vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            LOG_ARGS("submission of upload batch {} failed", _recording.ticket);
+        }
+    }
+    else
+    {
+        if(_freeSemaphores.empty())
+        {
+            VkSemaphoreCreateInfo semaphoreCreateInfo{};
+            semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+            VkSemaphore semaphore{VK_NULL_HANDLE};
+            if(vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS)
+            {
+                LOG("upload semaphore creation failed");
+            }
+            _freeSemaphores.push_back(semaphore);
+        }
+
+        _recording.released = _freeSemaphores.back();
+        _freeSemaphores.pop_back();
+
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &_recording.released;
+
+        if(vkQueueSubmit(_transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            LOG_ARGS("transfer submission of upload batch {} failed", _recording.ticket);
+        }
+
+        ///acquire on the graphics queue, its timeline signal covers both submissions
+        _recording.acquireCmdBuff = BeginCmdBuff(_graphicsCmdPool);
+
+        VkPipelineStageFlags stages{VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT};
+        if(_recording.acquireStages)
+            stages = _recording.acquireStages;
+
+        vkCmdPipelineBarrier(_recording.acquireCmdBuff, stages, stages, 0, 0, nullptr,
+                             _recording.bufferAcquires.size(), _recording.bufferAcquires.data(),
+                             _recording.imageAcquires.size(), _recording.imageAcquires.data());
+
+        for(const auto& chain : _recording.mipChains)
+            RecordMipChain(_recording.acquireCmdBuff, chain);
+
+        vkEndCommandBuffer(_recording.acquireCmdBuff);
+
+        VkSubmitInfo acquireSubmitInfo{};
+        acquireSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquireSubmitInfo.waitSemaphoreCount = 1;
+        acquireSubmitInfo.pWaitSemaphores = &_recording.released;
+        acquireSubmitInfo.pWaitDstStageMask = &stages;
+        acquireSubmitInfo.commandBufferCount = 1;
+        acquireSubmitInfo.pCommandBuffers = &_recording.acquireCmdBuff;
+        acquireSubmitInfo.pNext = &timelineSubmitInfo;
+        acquireSubmitInfo.signalSemaphoreCount = 1;
+        acquireSubmitInfo.pSignalSemaphores = &timeline;
+
+        if(vkQueueSubmit(_graphicsQueue, 1, &acquireSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            LOG_ARGS("acquire submission of upload batch {} failed", _recording.ticket);
+        }
+    }
+
+    _inFlight.push_back(std::move(_recording));
+    _recording = {};
+
+    return _inFlight.back().ticket;
+}
+
+bool UploadContext::IsComplete(UploadTicket ticket)
+{
+    return _timeline.Reached(ticket);
+}
+
+void UploadContext::Wait(UploadTicket ticket)
+{
+    _timeline.Wait(ticket);
+}
+
+void UploadContext::Collect()
+{
+    while(!_inFlight.empty() && IsComplete(_inFlight.front().ticket))
+    {
+        Retire(_inFlight.front());
+        _inFlight.pop_front();
+    }
+}
+
+void UploadContext::Retire(Batch& batch)
+{
+    for(auto[buff, memory] : batch.staging)
+        _allocator->DestroyBuffer(buff, memory);
+
+    _arenaUsed -= batch.arenaBytes;
+
+    vkFreeCommandBuffers(_device, _transferCmdPool, 1, &batch.cmdBuff);
+
+    if(batch.acquireCmdBuff != VK_NULL_HANDLE)
+        vkFreeCommandBuffers(_device, _graphicsCmdPool, 1, &batch.acquireCmdBuff);
+
+    if(batch.released != VK_NULL_HANDLE)
+        _freeSemaphores.push_back(batch.released);
+}
@@ -0,0 +1,147 @@
+#ifndef VULKANTUT2_UPLOADCONTEXT_H
+#define VULKANTUT2_UPLOADCONTEXT_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#include <tuple>
+
+#include "DeviceAllocator.h"
+#include "TimelineSemaphore.h"
+
+namespace VulkanTut
+{
+    ///monotonic id of a submitted batch and the value it signals on the upload timeline,
+    ///batches complete in submission order
+    using UploadTicket = uint64_t;
+
+    ///one tightly packed mip level inside the data handed to CopyToImage
+    struct ImageLevel
+    {
+        VkDeviceSize offset{0};
+        uint32_t width{0};
+        uint32_t height{0};
+    };
+
+    ///range of the staging arena filled by the caller before the copy is recorded
+    struct StagingSpan
+    {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+        VkDeviceSize size{0};
+        void* mapped{nullptr}; ///host visible, possibly write combined, only write to it
+    };
+
+    ///records buffer/image copies and their layout transitions into a single command buffer,
+    ///Submit() hands the whole batch to the queue, which signals the batch's ticket on a timeline
+    ///semaphore instead of idling the queue.
+    ///With a dedicated transfer family the copies run there and ownership is released to the
+    ///graphics family, which acquires it in a small command buffer waiting on a semaphore.
+    ///With a single family everything is recorded and submitted on the graphics queue.
+    class UploadContext
+    {
+        ///levels [firstLevel, mipLevels) are blitted from their predecessor on the graphics queue
+        struct MipChain
+        {
+            VkImage image{VK_NULL_HANDLE};
+            uint32_t width{0};  ///of firstLevel - 1
+            uint32_t height{0};
+            uint32_t firstLevel{1};
+            uint32_t mipLevels{1};
+            VkImageLayout finalLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+            VkAccessFlags dstAccess{0};
+            VkPipelineStageFlags dstStage{0};
+        };
+
+        struct Batch
+        {
+            VkCommandBuffer cmdBuff{VK_NULL_HANDLE};
+            VkCommandBuffer acquireCmdBuff{VK_NULL_HANDLE};
+            VkSemaphore released{VK_NULL_HANDLE};
+            UploadTicket ticket{0};
+            std::vector<std::tuple<VkBuffer, Allocation>> staging;
+
+            std::vector<VkBufferMemoryBarrier> bufferAcquires;
+            std::vector<VkImageMemoryBarrier> imageAcquires;
+            VkPipelineStageFlags acquireStages{0};
+            std::vector<MipChain> mipChains; ///recorded after the acquire barriers
+
+            VkDeviceSize arenaBytes{0}; ///staging arena bytes (padding and wrap included) released on retire
+        };
+
+        public:
+            UploadContext() = default;
+
+            void Create(VkDevice, DeviceAllocator&, VkQueue transferQueue, uint32_t transferFamily,
+                        VkQueue graphicsQueue, uint32_t graphicsFamily, VkDeviceSize stagingArenaSize = DefaultStagingArenaSize);
+            void Delete();
+
+            ///dstAccess/dstStage describe the first use on the graphics queue
+            void CopyToBuffer(const void* data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset,
+                              VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+            ///whole image (mip 0, layer 0) from tightly packed data, ends in finalLayout
+            void CopyToImage(const void* data, VkDeviceSize size, VkImage dst, uint32_t w, uint32_t h, VkImageLayout finalLayout,
+                             VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+            ///uploads the given levels, levels past them up to mipLevels are generated with linear blits,
+            ///the image needs TRANSFER_SRC usage and a format with BLIT_SRC|BLIT_DST|SAMPLED_IMAGE_FILTER_LINEAR then
+            void CopyToImage(const void* data, VkDeviceSize size, VkImage dst, const std::vector<ImageLevel>& levels, uint32_t mipLevels,
+                             VkImageLayout finalLayout, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+            ///same, with level offsets relative to a span the caller already wrote, no cpu copy at all
+            void CopyToImage(const StagingSpan&, VkImage dst, const std::vector<ImageLevel>& levels, uint32_t mipLevels,
+                             VkImageLayout finalLayout, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+            ///space for the next copy, sub-allocated from the arena and reclaimed when the batch retires.
+            ///Blocks on older batches when the ring is full, falls back to a dedicated buffer past its capacity
+            StagingSpan Reserve(VkDeviceSize size);
+
+            ///submits everything recorded since the last call, returns the ticket of that batch
+            UploadTicket Submit();
+            bool IsComplete(UploadTicket);
+            void Wait(UploadTicket);
+            ///releases staging memory and command buffers of finished batches
+            void Collect();
+
+            auto lastSubmitted() const { return _nextTicket - 1; }
+            auto isDedicatedTransfer() const { return _dedicated; }
+
+            static constexpr VkDeviceSize DefaultStagingArenaSize{32ull * 1024 * 1024};
+            ///offsets satisfy 4 byte and every texel block size copies need
+            static constexpr VkDeviceSize StagingAlignment{16};
+
+        private:
+            VkCommandBuffer Recording();
+            VkCommandBuffer BeginCmdBuff(VkCommandPool);
+            StagingSpan Stage(const void* data, VkDeviceSize size);
+            bool ReserveInArena(VkDeviceSize size, StagingSpan&);
+            void Retire(Batch&);
+            static void RecordMipChain(VkCommandBuffer, const MipChain&);
+
+        private:
+            VkDevice _device{VK_NULL_HANDLE};
+            DeviceAllocator* _allocator{nullptr};
+
+            bool _dedicated{false};
+            VkQueue _transferQueue{VK_NULL_HANDLE};
+            VkQueue _graphicsQueue{VK_NULL_HANDLE};
+            uint32_t _transferFamily{0};
+            uint32_t _graphicsFamily{0};
+            VkCommandPool _transferCmdPool{VK_NULL_HANDLE};
+            VkCommandPool _graphicsCmdPool{VK_NULL_HANDLE}; ///acquire side, only with a dedicated transfer family
+
+            Batch _recording{};
+            std::deque<Batch> _inFlight;
+            std::vector<VkSemaphore> _freeSemaphores;
+
+            ///persistently mapped staging ring, batches retire in submission order so it frees front to back
+            VkBuffer _arena{VK_NULL_HANDLE};
+            Allocation _arenaMemory{};
+            VkDeviceSize _arenaSize{0};
+            VkDeviceSize _arenaHead{0};
+            VkDeviceSize _arenaUsed{0};
+
+            UploadTicket _nextTicket{1};
+            TimelineSemaphore _timeline; ///counter value is the last completed ticket
+    };
+}
+
+#endif
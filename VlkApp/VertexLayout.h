@@ -0,0 +1,228 @@
+#ifndef VULKANTUT2_VERTEXLAYOUT_H
+#define VULKANTUT2_VERTEXLAYOUT_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+
+namespace VulkanTut
+{
+    ///vertex attribute encodings, each knows the VkFormat the vertex fetch decodes it with.
+    ///Constructors quantize at compile time so constexpr vertex tables store the encoded data directly
+    namespace VertexFormats
+    {
+        constexpr float Clamp(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+        constexpr float Abs(float v) { return v < 0.f ? -v : v; }
+        constexpr int32_t Round(float v) { return static_cast<int32_t>(v < 0.f ? v - .5f : v + .5f); }
+
+        constexpr int16_t ToSnorm16(float v) { return static_cast<int16_t>(Round(Clamp(v, -1.f, 1.f) * 32767.f)); }
+        constexpr uint16_t ToUnorm16(float v) { return static_cast<uint16_t>(Round(Clamp(v, 0.f, 1.f) * 65535.f)); }
+        constexpr uint8_t ToUnorm8(float v) { return static_cast<uint8_t>(Round(Clamp(v, 0.f, 1.f) * 255.f)); }
+
+        ///IEEE binary16, round to nearest even, out of range values become infinity
+        constexpr uint16_t ToHalf(float value)
+        {
+            const auto bits = std::bit_cast<uint32_t>(value);
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            const uint32_t floatExponent = (bits >> 23) & 0xFFu;
+            uint32_t mantissa = bits & 0x7FFFFFu;
+
+            if(floatExponent == 0xFFu)
+                return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+
+            const int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+            if(exponent >= 31)
+                return static_cast<uint16_t>(sign | 0x7C00u);
+
+            ///subnormal half, the implicit bit moves into the mantissa
+            uint32_t shift{13};
+            uint32_t half{0};
+            if(exponent <= 0)
+            {
+                if(exponent < -10)
+                    return static_cast<uint16_t>(sign);
+
+                mantissa |= 0x800000u;
+                shift = static_cast<uint32_t>(14 - exponent);
+            }
+            else
+            {
+                half = static_cast<uint32_t>(exponent) << 10;
+            }
+
+            half |= mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            ///a carry out of the mantissa correctly bumps the exponent
+            if(remainder > halfway || (remainder == halfway && (half & 1u)))
+                ++half;
+
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        struct Float2
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R32G32_SFLOAT};
+            float v[2]{};
+
+            constexpr Float2() = default;
+            constexpr Float2(float x, float y) : v{x, y} {}
+        };
+
+        struct Float3
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R32G32B32_SFLOAT};
+            float v[3]{};
+
+            constexpr Float3() = default;
+            constexpr Float3(float x, float y, float z) : v{x, y, z} {}
+        };
+
+        ///position of any range, w pads to 8 bytes (R16G16B16 is not a mandatory vertex format)
+        struct Half4
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R16G16B16A16_SFLOAT};
+            uint16_t v[4]{};
+
+            constexpr Half4() = default;
+            constexpr Half4(float x, float y, float z, float w = 1.f) : v{ToHalf(x), ToHalf(y), ToHalf(z), ToHalf(w)} {}
+        };
+
+        ///position within [-1, 1], larger meshes are scaled into the unit cube and the scale folded into the model matrix
+        struct Snorm16x4
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R16G16B16A16_SNORM};
+            int16_t v[4]{};
+
+            constexpr Snorm16x4() = default;
+            constexpr Snorm16x4(float x, float y, float z, float w = 1.f) : v{ToSnorm16(x), ToSnorm16(y), ToSnorm16(z), ToSnorm16(w)} {}
+        };
+
+        ///color, alpha defaults to opaque
+        struct Unorm8x4
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R8G8B8A8_UNORM};
+            uint8_t v[4]{};
+
+            constexpr Unorm8x4() = default;
+            constexpr Unorm8x4(float r, float g, float b, float a = 1.f) : v{ToUnorm8(r), ToUnorm8(g), ToUnorm8(b), ToUnorm8(a)} {}
+        };
+
+        ///texture coordinates within [0, 1], repeating UVs need a float encoding
+        struct Unorm16x2
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R16G16_UNORM};
+            uint16_t v[2]{};
+
+            constexpr Unorm16x2() = default;
+            constexpr Unorm16x2(float s, float t) : v{ToUnorm16(s), ToUnorm16(t)} {}
+        };
+
+        ///unit vector folded onto the octahedron and unwrapped into [-1, 1]^2. Decoded in the shader with
+        ///  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+        ///  if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        ///  n = normalize(n);
+        struct OctNormal
+        {
+            static constexpr VkFormat Format{VK_FORMAT_R16G16_SNORM};
+            int16_t v[2]{};
+
+            constexpr OctNormal() = default;
+            ///the input need not be normalized, the projection divides by its L1 norm
+            constexpr OctNormal(float x, float y, float z)
+            {
+                const float norm = Abs(x) + Abs(y) + Abs(z);
+                float u = norm > 0.f ? x / norm : 0.f;
+                float w = norm > 0.f ? y / norm : 0.f;
+
+                if(z < 0.f)
+                {
+                    const float foldedU = (1.f - Abs(w)) * (u >= 0.f ? 1.f : -1.f);
+                    const float foldedW = (1.f - Abs(u)) * (w >= 0.f ? 1.f : -1.f);
+                    u = foldedU;
+                    w = foldedW;
+                }
+
+                v[0] = ToSnorm16(u);
+                v[1] = ToSnorm16(w);
+            }
+        };
+    }
+
+    template<auto Member>
+    struct VertexMember;
+
+    template<typename Vertex, typename Attribute, Attribute Vertex::* Member>
+    struct VertexMember<Member>
+    {
+        using VertexType = Vertex;
+        using AttributeType = Attribute;
+
+        ///offsetof without naming the member: mark its bytes in a zeroed vertex and find the first marked one.
+        ///Fails to compile for vertices with padding, which is intended, vertices are meant to be packed
+        static constexpr uint32_t Offset()
+        {
+            std::array<unsigned char, sizeof(Attribute)> marker{};
+            marker.fill(1);
+
+            Vertex vertex{};
+            vertex.*Member = std::bit_cast<Attribute>(marker);
+
+            const auto bytes = std::bit_cast<std::array<unsigned char, sizeof(Vertex)>>(vertex);
+            for(uint32_t i{0}; i<bytes.size(); ++i)
+                if(bytes[i] != 0)
+                    return i;
+
+            return 0;
+        }
+    };
+
+    ///binding and attribute descriptions generated from members of a vertex struct, e.g.
+    ///VertexLayout<&Vertex::pos, &Vertex::color>. Members take consecutive locations in the order given,
+    ///their format comes from their VertexFormats type and their offset from the struct itself
+    template<auto First, auto... Rest>
+    class VertexLayout
+    {
+        public:
+            using Vertex = typename VertexMember<First>::VertexType;
+            static_assert((std::is_same_v<Vertex, typename VertexMember<Rest>::VertexType> && ...),
+                          "every attribute must be a member of the same vertex struct");
+
+            static constexpr uint32_t AttributeCount{1 + sizeof...(Rest)};
+            static constexpr uint32_t Stride{sizeof(Vertex)};
+
+            static constexpr VkVertexInputBindingDescription Binding(uint32_t binding, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+            {
+                return {binding, Stride, inputRate};
+            }
+
+            static constexpr std::array<VkVertexInputAttributeDescription, AttributeCount> Attributes(uint32_t binding, uint32_t firstLocation = 0)
+            {
+                std::array<VkVertexInputAttributeDescription, AttributeCount> attribDescs
+                {{
+                    Attribute<First>(),
+                    Attribute<Rest>()...
+                }};
+
+                for(uint32_t i{0}; i<AttributeCount; ++i)
+                {
+                    attribDescs[i].binding = binding;
+                    attribDescs[i].location = firstLocation + i;
+                }
+
+                return attribDescs;
+            }
+
+        private:
+            template<auto Member>
+            static constexpr VkVertexInputAttributeDescription Attribute()
+            {
+                using Traits = VertexMember<Member>;
+                return {0, 0, Traits::AttributeType::Format, Traits::Offset()};
+            }
+    };
+}
+
+#endif
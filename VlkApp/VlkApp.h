@@ -2,16 +2,33 @@
 #define VULKANTUT2_VLKAPP_H
 
 #include "EXTFnInvokers.h"
+#include "DeviceAllocator.h"
+#include "UniformRing.h"
+#include "UploadContext.h"
+#include "FrameStats.h"
+#include "PipelineCache.h"
+#include "DeletionQueue.h"
+#include "TimelineSemaphore.h"
+#include "DescriptorCache.h"
+#include "DescriptorTemplate.h"
 #include "Shader.h"
+#include "ShaderReloader.h"
+#include "PipelineState.h"
+#include "LatencyProfile.h"
 #include "quad.h"
 #include "Img.h"
+#include "CompressedImg.h"
 
 #include <vulkan/vulkan.h>
+#include <glm/vec4.hpp>
 #include <tuple>
 #include <optional>
 #include <vector>
 #include <array>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace VulkanTut
 {
@@ -51,87 +68,178 @@ namespace VulkanTut
             void CreateInstance(const std::vector<const char*>& instanceExtensions);
             void PickPhysicalDevice(const std::vector<const char*>& deviceExtensions);
             void CreateLogicalDevice(const std::vector<const char*>& deviceExtensions);
+            void CreateAllocator() { _allocator.Create(_device, _physicalDevice); }
             void CreateSwapChain(int32_t wpx, int32_t hpx, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+            ///headless replacement for CreateSwapChain
+            void CreateOffscreenTargets(uint32_t w, uint32_t h);
             void CreateImageViews();
             void CreateRenderPass();
-            void CreateProgram(std::string_view vSh, std::string_view fSh);
+            void CreateShaderLibrary() { _shaderLibrary.Create(_device); }
+            ///false when a stage failed to load
+            bool CreateProgram(std::string_view vSh, std::string_view fSh);
+            ///before any layout is created, layouts and immutable sets are cached, transient sets come from per frame pools
+            void CreateDescriptorCache();
             void CreateDescriptorSetLayout();
+            ///material variant CreatePipeline builds, set before it. The template form rejects invalid states at compile time
+            template<PipelineState State>
+            void SetMaterial()
+            {
+                static_assert(State.Valid(), "blending or depth testing conflicts with depth writes");
+                _material = State;
+            }
+            ///specialized pipeline for state, built once and cached by state hash until the program or render pass changes
+            VkPipeline GetPipelineVariant(const PipelineState&);
+            ///loads the on-disk cache used by every CreatePipeline, saved back in Delete
+            void CreatePipelineCache(std::string_view path) { _pipelineCache.Create(_device, _physicalDevice, path); }
             void CreatePipeline();
+            ///compute frustum culling feeding an indirect draw, no-op unless SetGpuDriven(true)
+            void CreateCulling(std::string_view cSh);
             void CreateSchFramebuffers();
             void CreateCommandPool();
+            void CreateUploadContext();
             void CreateDepthBuffer();
-            void CreateTexture(Img&&);
+            ///slots texture slots (bindless array elements) sharing a 2x2 checker until StreamTexture replaces them
+            void CreatePlaceholderTexture(uint32_t slots = 1);
+            ///replaces a slot's texture once its upload completed, the old one is retired through the deletion queue
+            void StreamTexture(uint32_t slot, Img&&);
+            bool StreamTexture(uint32_t slot, CompressedImg&&);
             void CreateTextureImageView();
             void CreateTextureSampler();
-            void CreateDescriptorPool();
             void CreateDescriptorSets();
-            void CreateQuad() { _quad.Create(_device, _physicalDevice, _graphicsQueue, _cmdPool); }
+            void CreateQuad() { _quad.Create(_allocator, _uploads); }
+            ///records the upload of a count instance grid, the previous buffer is retired, FlushUploads before drawing
+            void CreateInstances(uint32_t count);
             void CreateUniformBuffers();
             void CreateCommandBuffers();
+            ///binary semaphores for acquire and present, the swapchain cannot wait on or signal a timeline
             void CreateSemaphores();
-            void CreateFences();
+            void CreateFrameTimeline();
+            void CreateTimestampQueries();
+            ///after CreateCulling, rebuilds the pipelines of a changed shader on a background thread and swaps
+            ///them in at the next frame boundary. compiler (glslc) may be empty, then only SPIR-V is watched
+            void CreateShaderReloader(std::string_view compiler);
+            ///source is recompiled into spirv when a compiler was given
+            void WatchShader(std::string_view source, std::string_view spirv) { _shaderReloader.Watch(source, spirv); }
 
             void DrawFrame();
             void RecreateSwapchain();
-            void Update(uint32_t imgID);
+            ///dynamic offset of the frame's uniforms, nullopt when they did not fit into its ring segment
+            std::optional<uint32_t> Update(uint32_t frame);
+            ///submits pending uploads and blocks until they landed
+            void FlushUploads();
+
+            ///best of several rounds, cpu ms to write sets descriptor sets of two storage buffers and a sampled texture
+            struct DescriptorUpdateTimings
+            {
+                double writes{0};        ///vkUpdateDescriptorSets per set
+                double batchedWrites{0}; ///one vkUpdateDescriptorSets for every set
+                double templated{0};     ///vkUpdateDescriptorSetWithTemplate per set
+                std::optional<double> pushed; ///recording vkCmdPushDescriptorSetWithTemplateKHR, needs VK_KHR_push_descriptor
+            };
+            ///after CreateDescriptorSets
+            DescriptorUpdateTimings BenchmarkDescriptorUpdates(uint32_t sets);
 
             auto& getRecreationInfo() { return _recreationInfo; }
             auto getInstance() const { return _instance; }
+            const auto& getAllocator() const { return _allocator; }
+            const auto& getFrameStats() const { return _frameStats; }
+            auto& getFrameStats() { return _frameStats; }
+            auto getInstanceCount() const { return _instanceCount; }
+            const auto& getPipelineCache() const { return _pipelineCache; }
+            const auto& getShaderLibrary() const { return _shaderLibrary; }
+            const auto& getDescriptorCache() const { return _descriptorCache; }
             void SetSurface(VkSurfaceKHR surface) { _surface = surface; }
-
-            void Delete() const
+            ///no surface, no present support required, renders into offscreen targets
+            void SetHeadless(bool headless) { _headless = headless; }
+            ///instances are culled on the gpu and drawn with vkCmdDrawIndexedIndirect
+            void SetGpuDriven(bool gpuDriven) { _gpuDriven = gpuDriven; }
+            ///textures are indexed per instance from an update-after-bind array (VK_EXT_descriptor_indexing),
+            ///set before CreateLogicalDevice, falls back to the single texture binding when unsupported.
+            ///May still be turned off before CreateDescriptorSetLayout
+            void SetBindless(bool bindless) { _bindless = bindless; }
+            auto isBindless() const { return _bindless; }
+            ///frames in flight, present mode and swapchain depth. Before CreateSwapChain it applies directly,
+            ///afterwards at the start of the next DrawFrame (waits for the frames in flight, recreates the swapchain)
+            void SetLatencyProfile(LatencyProfile);
+            auto getLatencyProfile() const { return _pendingProfile.value_or(_latencyProfile); }
+            auto getFramesInFlight() const { return _framesInFlight; }
+            ///frame N signals N + 1 on the frame timeline once it finished on the gpu
+            bool IsFrameRetired(uint64_t frame) { return _frameTimeline.Reached(frame + 1); }
+            ///frames [0, count) finished on the gpu
+            uint64_t getRetiredFrames() { return _frameTimeline.Query(); }
+            auto getTextureCount() const { return static_cast<uint32_t>(_textures.size()); }
+
+            void Delete()
             {
+                ///rebuilds that already finished hand their pipelines over, so the deletion queue frees them
+                _shaderReloader.Delete();
+                _shaderReloader.Poll();
+
                 vkDeviceWaitIdle(_device);
+                _deletionQueue.FlushAll();
 
                 for(size_t i{0}; i<MAX_FRAMES_IN_FLIGHT; ++i)
                 {
-                    vkDestroyFence(_device, _inFlightFences[i], nullptr);
                     vkDestroySemaphore(_device, _renderFinishedSemaphores[i], nullptr);
                     vkDestroySemaphore(_device, _imgAvailableSemaphores[i], nullptr);
                 }
 
+                _frameTimeline.Delete();
+
+                if(_timestampPool != VK_NULL_HANDLE)
+                    vkDestroyQueryPool(_device, _timestampPool, nullptr);
+
                 vkDestroyCommandPool(_device, _cmdPool, nullptr);
+                _uploads.Delete();
 
                 vkDestroyImageView(_device, _depthImgView, nullptr);
-                vkDestroyImage(_device, _depthImg, nullptr);
-                vkFreeMemory(_device, _depthImgMemory, nullptr);
+                _allocator.DestroyImage(_depthImg, _depthImgMemory);
 
                 for(auto fbo : _swapChainFbos)
                     vkDestroyFramebuffer(_device, fbo, nullptr);
 
-                vkDestroyPipeline(_device, _pipeline, nullptr);
+                for(const auto&[state, pipeline] : _pipelineVariants)
+                    vkDestroyPipeline(_device, pipeline, nullptr);
                 vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
                 vkDestroyRenderPass(_device, _renderPass, nullptr);
 
-                _shader.Delete();
+                _pipelineCache.Save();
+                _pipelineCache.Delete();
 
                 for(auto imgView : _swapChainImageViews)
                     vkDestroyImageView(_device, imgView, nullptr);
 
-                for(size_t i{0}; i<_swapChainImages.size(); ++i)
-                {
-                    vkDestroyBuffer(_device, _uboBuffs[i], nullptr);
-                    vkFreeMemory(_device, _uboBuffsMem[i], nullptr);
-                }
+                _uboRing.Delete();
 
-                vkDestroyDescriptorPool(_device, _descPool, nullptr);
+                for(auto& frameDescriptors : _frameDescriptors)
+                    frameDescriptors.Delete();
 
-                vkDestroySwapchainKHR(_device, _swapChain, nullptr);
+                if(_headless)
+                {
+                    for(size_t i{0}; i<_swapChainImages.size(); ++i)
+                        _allocator.DestroyImage(_swapChainImages[i], _offscreenImgMemory[i]);
+                }
+                else
+                    vkDestroySwapchainKHR(_device, _swapChain, nullptr);
 
-                vkDestroySampler(_device, _texSampler, nullptr);
-                vkDestroyImageView(_device, _texImgView, nullptr);
-                vkDestroyImage(_device, _texImg, nullptr);
-                vkFreeMemory(_device, _texMem, nullptr);
+                DeleteTextures();
+                DeleteBindless();
 
-                vkDestroyDescriptorSetLayout(_device, _descriptorSetLayout, nullptr);
                 _quad.Delete();
+                DeleteCulling();
+                ///after the textures, their destruction evicts the sets that reference them
+                _descriptorCache.Delete();
+                _shaderLibrary.Delete();
+                _allocator.DestroyBuffer(_instanceBuffer, _instanceMemory);
 
+                _allocator.Delete();
                 vkDestroyDevice(_device, nullptr);
 
                 if(EnableValidationLayers)
                     DestroyDebugUtilsMessengerEXT(_instance, _debugMessenger, nullptr);
 
-                vkDestroySurfaceKHR(_instance, _surface, nullptr);
+                if(!_headless)
+                    vkDestroySurfaceKHR(_instance, _surface, nullptr);
                 vkDestroyInstance(_instance, nullptr);
             }
 
@@ -141,7 +249,17 @@ namespace VulkanTut
                 static constexpr bool EnableValidationLayers{true};
             #endif
 
-            static constexpr int32_t MAX_FRAMES_IN_FLIGHT{2};
+            ///per frame resources are created for this many slots, the latency profile picks how many cycle
+            static constexpr int32_t MAX_FRAMES_IN_FLIGHT{3};
+            static constexpr VkDeviceSize UBO_RING_SEGMENT_SIZE{64 * 1024};
+            ///descriptors per set the pools are sized with, covers every set layout of the app
+            static constexpr std::array<DescriptorRatio, 3> DescriptorRatios
+            {{
+                {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f},
+                {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1.f},
+                {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3.f}
+            }};
+            static constexpr uint32_t BINDLESS_TEXTURE_CAPACITY{4096}; ///clamped to the device's update-after-bind limits
             static constexpr std::array<const char*, 1> ValidationLayers
             {
                 "VK_LAYER_KHRONOS_validation"
@@ -156,28 +274,79 @@ namespace VulkanTut
             ///physical, logical device
             bool IsDeviceSuitable(VkPhysicalDevice device, const std::vector<const char*>& deviceExtensions);
             bool CheckDeviceExtensionsSupport(VkPhysicalDevice device, const std::vector<const char*>& deviceExtensions);
+            bool CheckTimelineSupport(VkPhysicalDevice device);
             QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
 
             ///swap chain
             SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice);
             static VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& avFormats);
-            static VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& avPresModes);
+            VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& avPresModes) const;
             static VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, int32_t wpx, int32_t hpx);
 
             ///memory, buffers, images
-            std::tuple<VkBuffer, VkDeviceMemory> CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags, VkSharingMode = VK_SHARING_MODE_EXCLUSIVE);
-            std::tuple<VkImage, VkDeviceMemory> CreateImage(uint32_t w, uint32_t h, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags, VkSharingMode = VK_SHARING_MODE_EXCLUSIVE);
-            VkImageView CreateImageView(VkImage, VkFormat, VkImageAspectFlags);
-            void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-            void CopyBufferToImage(VkBuffer buff, VkImage img, uint32_t w, uint32_t h);
-            static uint32_t FindMemType(VkPhysicalDevice pDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
-            ///tmp commands
-            VkCommandBuffer BeginCmd();
-            void EndCmd(VkCommandBuffer cmdBuff);
+            std::tuple<VkBuffer, Allocation> CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags, VkSharingMode = VK_SHARING_MODE_EXCLUSIVE);
+            std::tuple<VkImage, Allocation> CreateImage(uint32_t w, uint32_t h, VkFormat, VkImageTiling, VkImageUsageFlags, VkMemoryPropertyFlags,
+                                                        VkSharingMode = VK_SHARING_MODE_EXCLUSIVE, uint32_t mipLevels = 1);
+            VkImageView CreateImageView(VkImage, VkFormat, VkImageAspectFlags, uint32_t mipLevels = 1);
+
+            ///pipelines, the builders only read state fixed after setup so the reload thread may call them
+            VkPipeline BuildGraphicsPipeline(const ShaderProgram&, VkRenderPass, const PipelineState&, VkPipelineCreationFeedbackEXT*) const;
+            VkPipeline BuildCullPipeline(const ShaderProgram&) const;
+            ShaderReloader::Completion RebuildPipelines(const std::string& spirv, const ShaderProgram& graphics, const ShaderProgram& cull,
+                                                        const PipelineState& material);
+            void RetirePipeline(VkPipeline);
+            ///every cached variant, they were built against a program or render pass being replaced
+            void RetirePipelineVariants(uint64_t safeAfterFrames);
+
+            ///per frame commands
+            ///without uboOffset the render pass only clears
+            void RecordCommandBuffer(uint32_t frame, uint32_t imgID, std::optional<uint32_t> uboOffset);
+            void AdvanceFrame();
+            void ApplyLatencyProfile(LatencyProfile);
+
+            ///gpu driven culling
+            void CreateCullingBuffers();
+            ///false when nothing was recorded, the frame then draws every instance directly
+            bool RecordCulling(VkCommandBuffer, uint32_t frame);
+            void DeleteCulling();
+            static std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& clip);
 
             ///tex
+            struct Texture
+            {
+                VkImage img{VK_NULL_HANDLE};
+                VkImageView view{VK_NULL_HANDLE};
+                Allocation mem{};
+                uint32_t mipLevels{1};
+                VkFormat format{VK_FORMAT_R8G8B8A8_SRGB};
+            };
+
+            ///textures still bound in a stale set stay alive until every frame's set was rewritten
+            struct TextureSlot
+            {
+                Texture tex{};
+                UploadTicket ticket{0};
+                std::array<bool, MAX_FRAMES_IN_FLIGHT> stale{};
+                std::vector<Texture> retired;
+            };
+
             static VkDescriptorSetLayoutBinding GetSamplerLayoutBinding();
+            Texture CreateTextureRGBA8(const ubyte* pixels, uint32_t w, uint32_t h);
+            ///uploads the stored levels untouched, nullopt if the device can't sample the format
+            std::optional<Texture> CreateCompressedTexture(CompressedImg&&);
+            void BeginTextureSwap(uint32_t slot, Texture);
+            void WriteTextureDescriptors(uint32_t frame, uint32_t slot);
+            void UpdateTextureDescriptors(uint32_t frame);
+            ///cached set 0 for the current texture of slot 0
+            VkDescriptorSet GetMainSet();
+            void DestroyTexture(const Texture&);
+            void DeleteTextures();
+
+            ///bindless
+            bool CheckBindlessSupport();
+            void CreateBindlessLayout();
+            void CreateBindlessSets();
+            void DeleteBindless();
 
             ///depth buffer
             VkFormat FindSupportedFormat(const std::vector<VkFormat>& formats, VkImageTiling tiling, VkFormatFeatureFlags) const;
@@ -197,11 +366,15 @@ namespace VulkanTut
             VkDevice _device{VK_NULL_HANDLE};
             VkQueue _graphicsQueue{VK_NULL_HANDLE};
             VkQueue _transferQueue{VK_NULL_HANDLE};
+            ///device memory sub-allocator
+            DeviceAllocator _allocator;
             ///window surface and presentation
             VkSurfaceKHR _surface{VK_NULL_HANDLE};
             VkQueue _presentationQueue{VK_NULL_HANDLE};
 
-            ///swapchain
+            ///swapchain (or offscreen targets when headless)
+            bool _headless{false};
+            std::vector<Allocation> _offscreenImgMemory;
             volatile SchRecreationInfo _recreationInfo{};
             VkSwapchainKHR _swapChain{VK_NULL_HANDLE};
             std::vector<VkImage> _swapChainImages;
@@ -209,18 +382,54 @@ namespace VulkanTut
             VkExtent2D _swapChainExtent;
             ///image views
             std::vector<VkImageView> _swapChainImageViews;
-            ///ubos
-            std::vector<VkDescriptorSet> _descSets{VK_NULL_HANDLE};
-            VkDescriptorPool _descPool{VK_NULL_HANDLE};
-            std::vector<VkBuffer> _uboBuffs;
-            std::vector<VkDeviceMemory> _uboBuffsMem;
+            ///ubos, set 0 of each frame in flight is the cached set of the ubo ring and texture slot 0
+            std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> _descSets{};
+            UniformRing _uboRing;
+
+            ///descriptors
+            DescriptorCache _descriptorCache; ///owns every set layout
+            std::array<DescriptorAllocator, MAX_FRAMES_IN_FLIGHT> _frameDescriptors; ///transient sets, reset when the slot is reused
+            bool _pushDescriptors{false}; ///VK_KHR_push_descriptor enabled, transient sets are pushed instead of allocated
 
             ///Pipeline
             VkPipelineLayout _pipelineLayout{VK_NULL_HANDLE};
-            VkPipeline _pipeline{VK_NULL_HANDLE};
-            ShaderVF _shader; ///shader
+            VkPipeline _pipeline{VK_NULL_HANDLE}; ///variant of _material, owned by _pipelineVariants
+            PipelineState _material{Materials::Textured};
+            std::unordered_map<PipelineState, VkPipeline, PipelineStateHash> _pipelineVariants;
+            ShaderLibrary _shaderLibrary; ///owns every module, shared between programs
+            ShaderProgram _program; ///vertex + fragment
             VkRenderPass _renderPass{VK_NULL_HANDLE}; ///render pass
-            VkDescriptorSetLayout _descriptorSetLayout{VK_NULL_HANDLE}; ///descriptor layout for quad ubo
+            VkDescriptorSetLayout _descriptorSetLayout{VK_NULL_HANDLE}; ///descriptor layout for quad ubo, owned by _descriptorCache
+            PipelineCache _pipelineCache;
+            ShaderReloader _shaderReloader;
+            std::mutex _renderPassMutex; ///held by the reload thread while it builds against _renderPass
+            bool _pipelineFeedback{false}; ///VK_EXT_pipeline_creation_feedback enabled, feeds cache hit counters
+
+            ///per instance data, binding 1
+            VkBuffer _instanceBuffer{VK_NULL_HANDLE};
+            Allocation _instanceMemory{};
+            uint32_t _instanceCount{0};
+
+            ///gpu driven culling, compacted instances and the indirect command per frame in flight
+            struct CullFrame
+            {
+                VkBuffer visible{VK_NULL_HANDLE};
+                Allocation visibleMemory{};
+                VkBuffer indirect{VK_NULL_HANDLE};
+                Allocation indirectMemory{};
+            };
+
+            bool _gpuDriven{false};
+            ShaderProgram _cullProgram;
+            VkDescriptorSetLayout _cullSetLayout{VK_NULL_HANDLE};
+            DescriptorTemplate _cullTemplate; ///pushed when _pushDescriptors, otherwise writes a set from _frameDescriptors
+            VkPipelineLayout _cullPipelineLayout{VK_NULL_HANDLE};
+            VkPipeline _cullPipeline{VK_NULL_HANDLE};
+            std::array<CullFrame, MAX_FRAMES_IN_FLIGHT> _cullFrames{};
+            std::array<glm::vec4, 6> _frustumPlanes{};
+
+            ///per draw data of the current frame, set in Update and pushed while recording
+            drawConstants _drawConstants{};
 
             ///Framebuffer
             std::vector<VkFramebuffer> _swapChainFbos;
@@ -228,24 +437,48 @@ namespace VulkanTut
             ///Commands
             VkCommandPool _cmdPool;
             std::vector<VkCommandBuffer> _cmdBuffers;
-            ///semaphores and fences
+            UploadContext _uploads; ///batched staging uploads, transfer queue with ownership transfer to graphics
+            ///semaphores, indexed by frame in flight slot
             std::vector<VkSemaphore> _imgAvailableSemaphores;
             std::vector<VkSemaphore> _renderFinishedSemaphores;
-            std::vector<VkFence> _swapchainImgInFlightFences;
-            std::vector<VkFence> _inFlightFences;
+            ///the only cpu <-> gpu sync of the frame loop, frame N signals N + 1. A slot, its uniform segment,
+            ///timestamps and command buffer are reused once the frame _framesInFlight back retired
+            TimelineSemaphore _frameTimeline;
+            uint32_t _currentFrame{0}; ///frame in flight slot, < _framesInFlight
+            uint64_t _frameNumber{0};  ///frames submitted so far
+            uint32_t _framesInFlight{GetLatencyConfig(LatencyProfile::Balanced).framesInFlight};
+            LatencyProfile _latencyProfile{LatencyProfile::Balanced};
+            std::optional<LatencyProfile> _pendingProfile;
+            DeletionQueue _deletionQueue; ///objects retired by swapchain recreation
+
+            ///frame timing, 2 timestamps (render pass begin/end) per frame in flight
+            FrameStats _frameStats{};
+            VkQueryPool _timestampPool{VK_NULL_HANDLE};
+            double _timestampPeriodMs{.0};
+            uint64_t _timestampMask{0};
+            std::array<bool, MAX_FRAMES_IN_FLIGHT> _timestampsPending{};
+            ///when Update sampled the input of the frame in each slot, resolved after the slot's timeline wait
+            std::array<std::chrono::steady_clock::time_point, MAX_FRAMES_IN_FLIGHT> _inputTimes{};
+            std::array<bool, MAX_FRAMES_IN_FLIGHT> _inputPending{};
 
             ///quad (VBO, IBO, UBO)
             Quad _quad{};
 
-            ///Texture
-            VkImage _texImg{VK_NULL_HANDLE};
+            ///Texture, slot 0 is also bound at set 0 binding 1
             VkSampler _texSampler{VK_NULL_HANDLE};
-            VkImageView _texImgView{VK_NULL_HANDLE};
-            VkDeviceMemory _texMem{VK_NULL_HANDLE};
+            Texture _placeholderTex{}; ///shared by every slot nothing was streamed into yet
+            std::vector<TextureSlot> _textures;
+
+            ///bindless, set 1 holds a partially bound array of every slot, one set per frame in flight
+            bool _bindless{false};
+            uint32_t _bindlessCapacity{0};
+            VkDescriptorSetLayout _bindlessSetLayout{VK_NULL_HANDLE};
+            DescriptorAllocator _bindlessDescriptors; ///update-after-bind pools
+            std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> _bindlessSets{};
 
             ///depth buffer
             VkImage _depthImg;
-            VkDeviceMemory _depthImgMemory;
+            Allocation _depthImgMemory;
             VkImageView _depthImgView;
     };
 }
@@ -13,6 +13,7 @@ namespace VulkanTut
         {
             bool Iconified{false};
             std::function<void(int32_t, int32_t)> winResizeCallback{nullptr};
+            std::function<void(int32_t)> keyPressCallback{nullptr};
         };
 
         public:
@@ -43,6 +44,20 @@ namespace VulkanTut
                 });
             }
 
+            ///GLFW_KEY_* of every key press (repeats excluded)
+            void SetKeyPressCallback(const std::function<void(int32_t)>& fn)
+            {
+                _winData.keyPressCallback = fn;
+
+                glfwSetKeyCallback(_nativeWindow,
+                [](GLFWwindow* win, int32_t key, int32_t, int32_t action, int32_t){
+                    auto* ptr = static_cast<WinData*>(glfwGetWindowUserPointer(win));
+
+                    if(action == GLFW_PRESS)
+                        ptr->keyPressCallback(key);
+                });
+            }
+
             auto getResolutionPx() const
             {
                 int32_t w, h;
@@ -1,55 +1,449 @@
 #include "VlkApp/VlkApp.h"
+#include "VlkApp/AssetLoader.h"
 #include "Window.h"
+
+#include <array>
+#include <chrono>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
 using namespace VulkanTut;
 
-int main()
+static constexpr uint32_t DefaultHeadlessFrames{1000};
+static constexpr uint32_t HeadlessWidth{800};
+static constexpr uint32_t HeadlessHeight{600};
+static constexpr std::string_view PipelineCachePath{"pipeline_cache.bin"};
+static constexpr uint32_t BenchFramesPerStep{200};
+static constexpr uint32_t BenchWarmupFrames{10};
+static constexpr uint32_t BenchDescriptorSets{10'000};
+static constexpr std::string_view DefaultTexturePath{"stbimage/Lenna.png"};
+static constexpr std::string_view ShaderCompiler{VULKANTUT_GLSLC};
+///SPIR-V is compiled into the build tree, see compile_shader in CMakeLists.txt
+#define VULKANTUT_SPIRV(name) VULKANTUT_SPIRV_DIR "/" name
+///GLSL source -> SPIR-V the app loads, mirrors the compile_shader calls in CMakeLists.txt
+static constexpr std::array<std::pair<std::string_view, std::string_view>, 4> ShaderSources
+{{
+    {VULKANTUT_SHADER_DIR "/shader.vert", VULKANTUT_SPIRV("vert.spv")},
+    {VULKANTUT_SHADER_DIR "/shader.frag", VULKANTUT_SPIRV("frag.spv")},
+    {VULKANTUT_SHADER_DIR "/shader_bindless.frag", VULKANTUT_SPIRV("frag_bindless.spv")},
+    {VULKANTUT_SHADER_DIR "/cull.comp", VULKANTUT_SPIRV("cull.spv")}
+}};
+
+struct Options
 {
-    Window::InitGLFW();
-    Window win(800, 600);
+    std::optional<uint32_t> headlessFrames;
+    std::optional<uint32_t> benchFrames;
+    std::optional<uint32_t> latencyBenchFrames;
+    std::optional<uint32_t> descriptorBenchSets;
+    LatencyProfile latency{LatencyProfile::Balanced};
+    uint32_t instances{1};
+    bool gpuDriven{false};
+    bool bindless{false};
+    bool hotReload{false};
+    std::string_view material{"textured"};
+    std::string_view statsPath;
+    std::vector<std::string_view> texturePaths; ///one per slot, DefaultTexturePath when empty
+};
 
-    VlkApp vkApp{};
+///decoded on the loader's workers, .ktx2/.dds go up block compressed as stored,
+///anything else (or an unsupported compressed format) through stb_image
+static void StreamTexture(VlkApp& vkApp, AssetLoader& loader, uint32_t slot, std::string_view path)
+{
+    auto onImg = [&vkApp, slot](Img&& img){ vkApp.StreamTexture(slot, std::move(img)); };
 
-    auto instanceExtensions = Window::getVlkExtensions();
-    instanceExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    if(!CompressedImg::IsCompressedPath(path))
+    {
+        loader.LoadImage(std::string(path), onImg);
+        return;
+    }
 
-    std::vector<const char*> deviceExtensions { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-    auto[wpx, hpx] = win.getResolutionPx();
+    loader.LoadCompressedImage(std::string(path), [&vkApp, &loader, slot, onImg](CompressedImg&& img)
+    {
+        if(!vkApp.StreamTexture(slot, std::move(img)))
+            loader.LoadImage(std::string(DefaultTexturePath), onImg);
+    });
+}
 
-    win.SetWindowResizeCallback([&vkApp](int32_t w, int32_t h){vkApp.getRecreationInfo().Set(w, h);});
+///pipeline variants are compile time presets, unknown names keep the textured default
+static void SetMaterial(VlkApp& vkApp, std::string_view name)
+{
+    if(name == "untextured")
+        vkApp.SetMaterial<Materials::Untextured>();
+    else if(name == "texture-only")
+        vkApp.SetMaterial<Materials::TextureOnly>();
+    else if(name == "transparent")
+        vkApp.SetMaterial<Materials::Transparent>();
+    else
+        vkApp.SetMaterial<Materials::Textured>();
+}
 
-    vkApp.CreateInstance(instanceExtensions);
-    vkApp.SetSurface(win.getVlkSurface(vkApp.getInstance()));
-    vkApp.PickPhysicalDevice(deviceExtensions);
-    vkApp.CreateLogicalDevice(deviceExtensions);
-    vkApp.CreateSwapChain(wpx, hpx);
+///everything after the presentation targets (swapchain or offscreen images) exist
+static void CreateRenderer(VlkApp& vkApp, AssetLoader& loader, const Options& options)
+{
+    vkApp.SetGpuDriven(options.gpuDriven);
+    SetMaterial(vkApp, options.material);
+    vkApp.CreatePipelineCache(PipelineCachePath);
     vkApp.CreateImageViews();
     vkApp.CreateRenderPass();
-    vkApp.CreateProgram("Shaders/spirv/vert.spv", "Shaders/spirv/frag.spv");
+    vkApp.CreateShaderLibrary();
+    ///the single texture shader still renders when the bindless one is unavailable
+    if(!vkApp.CreateProgram(VULKANTUT_SPIRV("vert.spv"), vkApp.isBindless() ? VULKANTUT_SPIRV("frag_bindless.spv") : VULKANTUT_SPIRV("frag.spv")) &&
+       vkApp.isBindless())
+    {
+        vkApp.SetBindless(false);
+        vkApp.CreateProgram(VULKANTUT_SPIRV("vert.spv"), VULKANTUT_SPIRV("frag.spv"));
+    }
+    vkApp.CreateDescriptorCache();
     vkApp.CreateDescriptorSetLayout();
     vkApp.CreatePipeline();
+    vkApp.CreateCulling(VULKANTUT_SPIRV("cull.spv"));
     vkApp.CreateCommandPool();
+    vkApp.CreateUploadContext();
     vkApp.CreateDepthBuffer();
     vkApp.CreateSchFramebuffers();
-    vkApp.CreateTexture({"stbimage/Lenna.png"});
+    ///without bindless only the first texture is ever sampled
+    std::vector<std::string_view> texturePaths(options.texturePaths);
+    if(texturePaths.empty())
+        texturePaths.push_back(DefaultTexturePath);
+    if(!vkApp.isBindless())
+        texturePaths.resize(1);
+
+    vkApp.CreatePlaceholderTexture(static_cast<uint32_t>(texturePaths.size()));
     vkApp.CreateTextureImageView();
     vkApp.CreateTextureSampler();
-    vkApp.CreateDescriptorPool();
     vkApp.CreateQuad();
+    vkApp.CreateInstances(options.instances);
+    vkApp.FlushUploads();
     vkApp.CreateUniformBuffers();
     vkApp.CreateDescriptorSets();
     vkApp.CreateCommandBuffers();
     vkApp.CreateSemaphores();
-    vkApp.CreateFences();
+    vkApp.CreateFrameTimeline();
+    vkApp.CreateTimestampQueries();
+
+    if(options.hotReload)
+    {
+        vkApp.CreateShaderReloader(ShaderCompiler);
+        for(const auto&[source, spirv] : ShaderSources)
+            vkApp.WatchShader(source, spirv);
+    }
+
+    for(uint32_t slot{0}; slot<vkApp.getTextureCount(); ++slot)
+        StreamTexture(vkApp, loader, slot, texturePaths[slot]);
+
+    vkApp.getAllocator().PrintStats();
+    vkApp.getPipelineCache().PrintStats();
+    vkApp.getShaderLibrary().PrintStats();
+    vkApp.getDescriptorCache().PrintStats();
+}
+
+static void ReportLatency(const VlkApp& vkApp)
+{
+    const auto profile = vkApp.getLatencyProfile();
+    auto latency = vkApp.getFrameStats().Summarize(FrameStage::Latency);
+    fmt::print("| {} | {} frames in flight | latency mean {:.3f} ms | p95 {:.3f} ms |\n",
+               LatencyProfileNames[static_cast<size_t>(profile)], GetLatencyConfig(profile).framesInFlight, latency.mean, latency.p95);
+}
+
+static void ReportStats(const VlkApp& vkApp, std::string_view statsPath)
+{
+    vkApp.getFrameStats().Print();
+
+    if(!statsPath.empty())
+        vkApp.getFrameStats().Export(std::string(statsPath));
+}
+
+static int RunWindowed(const Options& options)
+{
+    Window::InitGLFW();
+    Window win(800, 600);
+
+    VlkApp vkApp{};
+    AssetLoader loader{};
+    loader.Create();
+
+    auto instanceExtensions = Window::getVlkExtensions();
+    instanceExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+
+    std::vector<const char*> deviceExtensions { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    auto[wpx, hpx] = win.getResolutionPx();
+
+    win.SetWindowResizeCallback([&vkApp](int32_t w, int32_t h){vkApp.getRecreationInfo().Set(w, h);});
+    ///1, 2, 3 switch latency profiles on the fly, the outgoing one's latency is reported first
+    win.SetKeyPressCallback([&vkApp](int32_t key)
+    {
+        if(key < GLFW_KEY_1 || key >= GLFW_KEY_1 + static_cast<int32_t>(LatencyProfile::Count))
+            return;
+
+        ReportLatency(vkApp);
+        vkApp.getFrameStats().Reset();
+        vkApp.SetLatencyProfile(static_cast<LatencyProfile>(key - GLFW_KEY_1));
+    });
+
+    vkApp.CreateInstance(instanceExtensions);
+    vkApp.SetSurface(win.getVlkSurface(vkApp.getInstance()));
+    vkApp.PickPhysicalDevice(deviceExtensions);
+    vkApp.SetBindless(options.bindless);
+    vkApp.CreateLogicalDevice(deviceExtensions);
+    vkApp.CreateAllocator();
+    vkApp.SetLatencyProfile(options.latency);
+    vkApp.CreateSwapChain(wpx, hpx);
+    CreateRenderer(vkApp, loader, options);
 
     while(!win.IsClosed())
     {
         glfwPollEvents();
+        loader.Poll();
 
         if(!win.IsMinimized())
             vkApp.DrawFrame();
     }
 
+    ReportStats(vkApp, options.statsPath);
+
+    loader.Delete();
     vkApp.Delete();
 
     return 0;
 }
+
+static void CreateHeadless(VlkApp& vkApp, AssetLoader& loader, const Options& options)
+{
+    vkApp.SetHeadless(true);
+
+    std::vector<const char*> instanceExtensions { VK_EXT_DEBUG_UTILS_EXTENSION_NAME };
+    std::vector<const char*> deviceExtensions{};
+
+    vkApp.CreateInstance(instanceExtensions);
+    vkApp.PickPhysicalDevice(deviceExtensions);
+    vkApp.SetBindless(options.bindless);
+    vkApp.CreateLogicalDevice(deviceExtensions);
+    vkApp.CreateAllocator();
+    vkApp.SetLatencyProfile(options.latency);
+    vkApp.CreateOffscreenTargets(HeadlessWidth, HeadlessHeight);
+    CreateRenderer(vkApp, loader, options);
+}
+
+///no window, surface or swapchain, works on software ICDs (lavapipe) for CPU frame cost measurements
+static int RunHeadless(uint32_t frameCount, const Options& options)
+{
+    VlkApp vkApp{};
+    AssetLoader loader{};
+    loader.Create();
+    CreateHeadless(vkApp, loader, options);
+
+    auto beginTime = std::chrono::steady_clock::now();
+
+    for(uint32_t i{0}; i<frameCount; ++i)
+    {
+        loader.Poll();
+        vkApp.DrawFrame();
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    auto totalMs = std::chrono::duration<double, std::milli>(endTime - beginTime).count();
+    fmt::print("| headless | {} frames | {:.3f} ms total | {:.4f} ms/frame |\n",
+               frameCount, totalMs, frameCount ? totalMs / frameCount : .0);
+
+    ReportStats(vkApp, options.statsPath);
+
+    loader.Delete();
+    vkApp.Delete();
+
+    return 0;
+}
+
+///headless, instance count scaled 1 -> 1M by powers of 10, frame and gpu time per step
+static int RunInstanceBenchmark(uint32_t framesPerStep, const Options& options)
+{
+    VlkApp vkApp{};
+    AssetLoader loader{};
+    loader.Create();
+    CreateHeadless(vkApp, loader, options);
+
+    ///steps measure the final texture, not the placeholder (a completion may queue a fallback load)
+    while(loader.pending())
+    {
+        loader.WaitIdle();
+        loader.Poll();
+    }
+
+    fmt::print("| instances | cpu total mean ms | cpu total p95 ms | gpu mean ms | gpu p95 ms |\n");
+
+    for(uint32_t instances{1}; instances<=1'000'000; instances *= 10)
+    {
+        vkApp.CreateInstances(instances);
+        vkApp.FlushUploads();
+
+        for(uint32_t i{0}; i<BenchWarmupFrames; ++i)
+            vkApp.DrawFrame();
+
+        vkApp.getFrameStats().Reset();
+
+        for(uint32_t i{0}; i<framesPerStep; ++i)
+            vkApp.DrawFrame();
+
+        const auto& stats = vkApp.getFrameStats();
+        auto total = stats.Summarize(FrameStage::Total);
+        auto gpu = stats.Summarize(FrameStage::Gpu);
+        fmt::print("| {:>9} | {:>17.4f} | {:>16.4f} | {:>11.4f} | {:>10.4f} |\n",
+                   instances, total.mean, total.p95, gpu.mean, gpu.p95);
+    }
+
+    loader.Delete();
+    vkApp.Delete();
+
+    return 0;
+}
+
+///headless, every latency profile in turn, nothing is presented so latency ends at gpu completion
+static int RunLatencyBenchmark(uint32_t framesPerProfile, const Options& options)
+{
+    VlkApp vkApp{};
+    AssetLoader loader{};
+    loader.Create();
+    CreateHeadless(vkApp, loader, options);
+
+    while(loader.pending())
+    {
+        loader.WaitIdle();
+        loader.Poll();
+    }
+
+    fmt::print("| profile | frames in flight | latency mean ms | latency p95 ms | cpu total mean ms | gpu mean ms |\n");
+
+    for(uint32_t p{0}; p<static_cast<uint32_t>(LatencyProfile::Count); ++p)
+    {
+        const auto profile = static_cast<LatencyProfile>(p);
+        vkApp.SetLatencyProfile(profile);
+
+        for(uint32_t i{0}; i<BenchWarmupFrames; ++i)
+            vkApp.DrawFrame();
+
+        vkApp.getFrameStats().Reset();
+
+        for(uint32_t i{0}; i<framesPerProfile; ++i)
+            vkApp.DrawFrame();
+
+        const auto& stats = vkApp.getFrameStats();
+        auto latency = stats.Summarize(FrameStage::Latency);
+        auto total = stats.Summarize(FrameStage::Total);
+        auto gpu = stats.Summarize(FrameStage::Gpu);
+        fmt::print("| {:<14} | {:>16} | {:>15.4f} | {:>14.4f} | {:>17.4f} | {:>11.4f} |\n",
+                   LatencyProfileNames[p], GetLatencyConfig(profile).framesInFlight,
+                   latency.mean, latency.p95, total.mean, gpu.mean);
+    }
+
+    loader.Delete();
+    vkApp.Delete();
+
+    return 0;
+}
+
+///headless, cpu cost of writing per object descriptor sets with VkWriteDescriptorSet arrays vs update templates
+static int RunDescriptorBenchmark(uint32_t sets, const Options& options)
+{
+    VlkApp vkApp{};
+    AssetLoader loader{};
+    loader.Create();
+    CreateHeadless(vkApp, loader, options);
+
+    auto timings = vkApp.BenchmarkDescriptorUpdates(sets);
+
+    auto perSetNs = [sets](double ms){ return sets ? ms * 1e6 / sets : .0; };
+    auto row = [&](std::string_view path, double ms)
+    {
+        fmt::print("| {:<22} | {:>6} | {:>12.4f} | {:>10.1f} |\n", path, sets, ms, perSetNs(ms));
+    };
+
+    fmt::print("| path | sets | best ms | ns per set |\n");
+    row("writes per set", timings.writes);
+    row("writes batched", timings.batchedWrites);
+    row("template per set", timings.templated);
+    if(timings.pushed.has_value())
+        row("push template (record)", timings.pushed.value());
+    else
+        fmt::print("| push template (record) | VK_KHR_push_descriptor unsupported |\n");
+
+    loader.Delete();
+    vkApp.Delete();
+
+    return 0;
+}
+
+static std::optional<LatencyProfile> ParseLatencyProfile(std::string_view name)
+{
+    for(uint32_t p{0}; p<LatencyProfileNames.size(); ++p)
+        if(LatencyProfileNames[p] == name)
+            return static_cast<LatencyProfile>(p);
+
+    return std::nullopt;
+}
+
+///accepts an optional count following the current argument
+static std::optional<uint32_t> ParseCount(int& i, int argc, char** argv)
+{
+    if(i + 1 >= argc)
+        return std::nullopt;
+
+    std::string_view count(argv[i + 1]);
+    uint32_t value{0};
+    if(auto[ptr, ec] = std::from_chars(count.data(), count.data() + count.size(), value); ec != std::errc{})
+        return std::nullopt;
+
+    ++i;
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    Options options{};
+
+    for(int i{1}; i<argc; ++i)
+    {
+        std::string_view arg(argv[i]);
+
+        if(arg == "--stats" && i + 1 < argc)
+            options.statsPath = argv[++i];
+        else if(arg == "--texture" && i + 1 < argc)
+            options.texturePaths.emplace_back(argv[++i]);
+        else if(arg == "--bindless")
+            options.bindless = true;
+        else if(arg == "--hot-reload")
+            options.hotReload = true;
+        else if(arg == "--material" && i + 1 < argc)
+            options.material = argv[++i];
+        else if(arg == "--latency" && i + 1 < argc)
+            options.latency = ParseLatencyProfile(argv[++i]).value_or(options.latency);
+        else if(arg == "--bench-latency")
+            options.latencyBenchFrames = ParseCount(i, argc, argv).value_or(BenchFramesPerStep);
+        else if(arg == "--headless")
+            options.headlessFrames = ParseCount(i, argc, argv).value_or(DefaultHeadlessFrames);
+        else if(arg == "--instances")
+            options.instances = ParseCount(i, argc, argv).value_or(options.instances);
+        else if(arg == "--gpu-driven")
+            options.gpuDriven = true;
+        else if(arg == "--bench-instances")
+            options.benchFrames = ParseCount(i, argc, argv).value_or(BenchFramesPerStep);
+        else if(arg == "--bench-descriptors")
+            options.descriptorBenchSets = ParseCount(i, argc, argv).value_or(BenchDescriptorSets);
+    }
+
+    if(options.benchFrames.has_value())
+        return RunInstanceBenchmark(options.benchFrames.value(), options);
+
+    if(options.latencyBenchFrames.has_value())
+        return RunLatencyBenchmark(options.latencyBenchFrames.value(), options);
+
+    if(options.descriptorBenchSets.has_value())
+        return RunDescriptorBenchmark(options.descriptorBenchSets.value(), options);
+
+    if(options.headlessFrames.has_value())
+        return RunHeadless(options.headlessFrames.value(), options);
+
+    return RunWindowed(options);
+}
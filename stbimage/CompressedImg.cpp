@@ -0,0 +1,319 @@
+#include "CompressedImg.h"
+#include "errLog.h"
+#include "MipGen.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace VulkanTut;
+
+namespace
+{
+    template<typename T>
+    bool ReadAt(const MappedFile& file, size_t offset, T& value)
+    {
+        if(offset > file.size() || file.size() - offset < sizeof(T))
+            return false;
+
+        std::memcpy(&value, file.data() + offset, sizeof(T));
+        return true;
+    }
+
+    constexpr uint32_t FourCC(char a, char b, char c, char d)
+    {
+        return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+               (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    size_t LevelSize(const BlockInfo& block, uint32_t w, uint32_t h)
+    {
+        return static_cast<size_t>((w + block.width - 1) / block.width) *
+               ((h + block.height - 1) / block.height) * block.bytes;
+    }
+
+    constexpr std::array<ubyte, 12> KTX2Identifier
+    {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+
+    ///the file places the 64 bit sgd fields right after 13 u32, unpadded
+    #pragma pack(push, 4)
+    struct KTX2Header
+    {
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    #pragma pack(pop)
+    static_assert(sizeof(KTX2Header) == 68);
+
+    struct KTX2LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    struct DDSPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t rBitMask;
+        uint32_t gBitMask;
+        uint32_t bBitMask;
+        uint32_t aBitMask;
+    };
+
+    struct DDSHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DDSPixelFormat pixelFormat;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+    static_assert(sizeof(DDSHeader) == 124);
+
+    struct DDSHeaderDXT10
+    {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    constexpr uint32_t DDSMagic{FourCC('D', 'D', 'S', ' ')};
+    constexpr uint32_t DDSCubemapFlag{0x200};
+
+    ///legacy fourCC files carry no color space, DXT1/DXT5 are assumed to hold sRGB color
+    VkFormat FromDDSFourCC(uint32_t fourCC)
+    {
+        switch(fourCC)
+        {
+            case FourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case FourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_SRGB_BLOCK;
+            case FourCC('A', 'T', 'I', '2'):
+            case FourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+            case FourCC('B', 'C', '5', 'S'): return VK_FORMAT_BC5_SNORM_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    VkFormat FromDXGI(uint32_t dxgiFormat)
+    {
+        switch(dxgiFormat)
+        {
+            case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+            case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+            case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+            case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+            case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+            case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+            case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+}
+
+BlockInfo VulkanTut::GetBlockInfo(VkFormat format)
+{
+    switch(format)
+    {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            return {4, 4, 8};
+
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            return {4, 4, 16};
+
+        case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+            return {5, 5, 16};
+
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            return {6, 6, 16};
+
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            return {8, 8, 16};
+
+        default:
+            return {};
+    }
+}
+
+bool CompressedImg::IsCompressedPath(std::string_view path)
+{
+    return path.ends_with(".ktx2") || path.ends_with(".dds");
+}
+
+CompressedImg::CompressedImg(std::string_view path)
+    : file(path)
+{
+    if(!file.valid())
+        return;
+
+    const bool loaded = path.ends_with(".ktx2") ? LoadKTX2() : LoadDDS();
+    if(!loaded)
+    {
+        LOG_ARGS("{} is not a supported block compressed 2D texture", path);
+        format = VK_FORMAT_UNDEFINED;
+        levels.clear();
+        file = {};
+    }
+}
+
+bool CompressedImg::LoadKTX2()
+{
+    if(file.size() < KTX2Identifier.size() || !std::equal(KTX2Identifier.begin(), KTX2Identifier.end(), file.data()))
+        return false;
+
+    KTX2Header header{};
+    if(!ReadAt(file, KTX2Identifier.size(), header))
+        return false;
+
+    format = static_cast<VkFormat>(header.vkFormat);
+    const auto block = GetBlockInfo(format);
+
+    if(!block.bytes || header.supercompressionScheme != 0 || header.pixelDepth > 1 ||
+       header.layerCount > 1 || header.faceCount != 1 || !header.pixelWidth || !header.pixelHeight)
+        return false;
+
+    width = header.pixelWidth;
+    height = header.pixelHeight;
+
+    ///levelCount 0 asks the loader to generate mips, blits can't produce block compressed data so only level 0 is used
+    const auto levelCount = std::max(header.levelCount, 1u);
+    ///more levels than the full chain is invalid for vkCreateImage and would shift the extent by 32 or more
+    if(levelCount > MipLevelCount(width, height))
+        return false;
+
+    const size_t levelIndexOffset = KTX2Identifier.size() + sizeof(KTX2Header);
+
+    ///levels are stored smallest first, offsets are made relative to the lowest one
+    size_t begin{file.size()};
+    size_t end{0};
+
+    for(uint32_t i{0}; i<levelCount; ++i)
+    {
+        KTX2LevelIndex index{};
+        if(!ReadAt(file, levelIndexOffset + i * sizeof(KTX2LevelIndex), index))
+            return false;
+
+        const auto w = std::max(width >> i, 1u);
+        const auto h = std::max(height >> i, 1u);
+        const auto size = LevelSize(block, w, h);
+
+        if(index.byteLength != size || index.byteOffset > file.size() || file.size() - index.byteOffset < size)
+            return false;
+
+        levels.push_back({static_cast<size_t>(index.byteOffset), size, w, h});
+        begin = std::min(begin, static_cast<size_t>(index.byteOffset));
+        end = std::max(end, static_cast<size_t>(index.byteOffset) + size);
+    }
+
+    for(auto& level : levels)
+        level.offset -= begin;
+
+    dataOffset = begin;
+    dataSize = end - begin;
+
+    return true;
+}
+
+bool CompressedImg::LoadDDS()
+{
+    uint32_t magic{0};
+    DDSHeader header{};
+    if(!ReadAt(file, 0, magic) || magic != DDSMagic || !ReadAt(file, sizeof(magic), header) || header.size != sizeof(DDSHeader))
+        return false;
+
+    size_t offset = sizeof(magic) + sizeof(DDSHeader);
+
+    if(header.pixelFormat.fourCC == FourCC('D', 'X', '1', '0'))
+    {
+        DDSHeaderDXT10 dxt10{};
+        if(!ReadAt(file, offset, dxt10) || dxt10.arraySize > 1)
+            return false;
+
+        format = FromDXGI(dxt10.dxgiFormat);
+        offset += sizeof(DDSHeaderDXT10);
+    }
+    else
+    {
+        format = FromDDSFourCC(header.pixelFormat.fourCC);
+    }
+
+    const auto block = GetBlockInfo(format);
+    if(!block.bytes || (header.caps2 & DDSCubemapFlag) || header.depth > 1 || !header.width || !header.height)
+        return false;
+
+    width = header.width;
+    height = header.height;
+
+    ///levels are stored largest first, back to back
+    dataOffset = offset;
+
+    const auto levelCount = std::max(header.mipMapCount, 1u);
+    if(levelCount > MipLevelCount(width, height))
+        return false;
+
+    for(uint32_t i{0}; i<levelCount; ++i)
+    {
+        const auto w = std::max(width >> i, 1u);
+        const auto h = std::max(height >> i, 1u);
+        const auto size = LevelSize(block, w, h);
+
+        if(offset > file.size() || file.size() - offset < size)
+            return false;
+
+        levels.push_back({offset - dataOffset, size, w, h});
+        offset += size;
+    }
+
+    dataSize = offset - dataOffset;
+
+    return true;
+}
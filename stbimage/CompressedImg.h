@@ -0,0 +1,59 @@
+#ifndef VULKANTUT2_COMPRESSEDIMG_H
+#define VULKANTUT2_COMPRESSEDIMG_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string_view>
+
+#include "Img.h"
+#include "MappedFile.h"
+
+namespace VulkanTut
+{
+    ///texel block footprint of a block compressed format
+    struct BlockInfo
+    {
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t bytes{0};
+    };
+
+    ///BC1/3/5/7, ETC2 and ASTC LDR, zero sized for anything else
+    BlockInfo GetBlockInfo(VkFormat);
+
+    ///pre-compressed 2D texture (.ktx2 or .dds) kept as stored, no decoding happens on the cpu.
+    ///The file is mmapped and the levels are staged straight from the mapping.
+    ///Only single layer, single face images without supercompression are accepted
+    struct CompressedImg
+    {
+        struct Level
+        {
+            size_t offset{0}; ///from data()
+            size_t size{0};
+            uint32_t width{0};
+            uint32_t height{0};
+        };
+
+        CompressedImg(std::string_view path);
+
+        [[nodiscard]] bool valid() const { return format != VK_FORMAT_UNDEFINED && !levels.empty(); }
+        ///every level, plus whatever padding the file keeps between them
+        [[nodiscard]] const ubyte* data() const { return file.data() + dataOffset; }
+        [[nodiscard]] size_t size() const { return dataSize; }
+        static bool IsCompressedPath(std::string_view path);
+
+        MappedFile file;
+        size_t dataOffset{0};
+        size_t dataSize{0};
+        std::vector<Level> levels; ///level 0 first
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        uint32_t width{0};
+        uint32_t height{0};
+
+        private:
+            bool LoadKTX2();
+            bool LoadDDS();
+    };
+}
+
+#endif
@@ -7,17 +7,19 @@
 
 using namespace VulkanTut;
 
+void Img::PixelsDeleter::operator()(ubyte* ptr) const
+{
+    stbi_image_free(ptr);
+}
+
 Img::Img(std::string_view path)
 {
-    ubyte* ptr = stbi_load(path.data(), &width, &height, &channels, STBI_rgb_alpha);
+    pixels.reset(stbi_load(path.data(), &width, &height, &channels, STBI_rgb_alpha));
 
-    if(!ptr)
+    if(!pixels)
     {
         LOG_ARGS("loading of img at {} failed", path);
+        width = 0;
+        height = 0;
     }
-
-    pixels.resize(width * height * 4);
-    memcpy(pixels.data(), ptr, pixels.size());
-
-    stbi_image_free(ptr);
 }
@@ -1,7 +1,7 @@
 #ifndef VULKANTUT2_IMG_H
 #define VULKANTUT2_IMG_H
 
-#include <vector>
+#include <memory>
 #include <string_view>
 
 namespace VulkanTut
@@ -10,13 +10,23 @@ namespace VulkanTut
 
     struct Img
     {
+        ///releases the stb_image allocation
+        struct PixelsDeleter
+        {
+            void operator()(ubyte*) const;
+        };
+
         Img(std::string_view path);
 
-        std::vector<ubyte> pixels;
-        int32_t width;
-        int32_t height;
+        [[nodiscard]] bool valid() const { return pixels != nullptr; }
+        [[nodiscard]] size_t size() const { return static_cast<size_t>(width) * height * 4; }
+
+        ///rgba8 exactly as decoded, kept in stb's buffer instead of being copied out
+        std::unique_ptr<ubyte, PixelsDeleter> pixels;
+        int32_t width{0};
+        int32_t height{0};
         int32_t channels{4};
     };
 }
 
-#endif
\ No newline at end of file
+#endif
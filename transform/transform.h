@@ -2,15 +2,29 @@
 #define VULKANTUT2_TRANSFORM_H
 
 #include <glm/mat4x4.hpp>
+#include <cstddef>
+#include <cstdint>
 
 namespace VulkanTut
 {
+    ///per frame, uniform buffer binding 0, cameraUBO in shader.vert
     struct transform
     {
-        glm::mat4 model;
         glm::mat4 view;
         glm::mat4 proj;
     };
+
+    ///per draw, drawConstants in shader.vert, recorded with vkCmdPushConstants, well under the 128 bytes every device guarantees
+    struct drawConstants
+    {
+        glm::mat4 model;
+        uint32_t texIndexBase; ///added to the per instance texIndex
+    };
+
+    ///the GLSL blocks are std140 / push constant layouts, these must match them member for member
+    static_assert(sizeof(transform) == 128 && offsetof(transform, proj) == 64);
+    static_assert(offsetof(drawConstants, texIndexBase) == 64);
+    static_assert(sizeof(drawConstants) <= 128);
 }
 
 #endif
\ No newline at end of file